@@ -1,15 +1,27 @@
 #include "include/Matrix.hpp"
+#include "include/MatrixIO.hpp"
 
 using namespace matrix;
 
-int main()
+int main(int argc, char* argv[])
 {
     try {
-        std::cin.exceptions(std::cin.failbit);
-        size_t size = 0;
-        std::cin >> size;
-        Matrix<double> m{size};
-        std::cin >> m;
+        Matrix<double> m;
+        if (argc > 1 && isBinaryFile(argv[1])) {
+            m = readBinary<double>(argv[1]);
+        } else {
+            std::ifstream file;
+            if (argc > 1) {
+                file.open(argv[1], std::ios::in);
+                if (!file) {
+                    throw std::runtime_error(std::string("Can't open file ") + argv[1]);
+                }
+            }
+            BlockReader reader{argc > 1 ? file : std::cin};
+            size_t size = reader.next<size_t>();
+            m = Matrix<double>{size, size, uninitialized};
+            reader.read(m);
+        }
         std::cout << m.det();
     } catch (const std::exception& e) {
         std::cout << "Error: " << e.what() << std::endl;
@@ -0,0 +1,129 @@
+#pragma once
+
+/*
+Struct Uninitialized. Tag for constructors that leave trivial elements uninitialized,
+because the caller is going to overwrite every one of them (gemm product, transpose target).
+
+Class AlignedAllocator. Default allocator of Storage. Memory is aligned to Alignment
+bytes (cache line by default), so rows can be processed with aligned SIMD loads.
+
+Class HugePageAllocator. Allocator for large matrices. Requests bigger than hugePageSize
+are mapped with mmap and advised to be backed by transparent huge pages, smaller ones
+are served by AlignedAllocator.
+*/
+
+#include <new>
+#include <limits>
+#include <cstddef>
+#include <sys/mman.h>
+
+namespace matrix {
+
+struct Uninitialized {};
+
+inline constexpr Uninitialized uninitialized{};
+
+inline constexpr std::size_t cacheLineSize = 64U;
+
+inline constexpr std::size_t hugePageSize = 2U * 1024U * 1024U;
+
+template<typename T, std::size_t Alignment = cacheLineSize>
+class AlignedAllocator
+{
+    static_assert(Alignment >= alignof(T), "Alignment is less than alignof(T)");
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment isn't power of 2");
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using pointer = T *;
+
+    template<typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    pointer allocate(size_type n) {
+        if (n > std::numeric_limits<size_type>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<pointer>(::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+    }
+
+    void deallocate(pointer ptr, size_type) noexcept {
+        ::operator delete(ptr, std::align_val_t{Alignment});
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return true;
+    }
+};
+
+template<typename T>
+class HugePageAllocator
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using pointer = T *;
+
+private:
+    static size_type mappedSize(size_type n) {
+        return (n * sizeof(T) + hugePageSize - 1U) / hugePageSize * hugePageSize;
+    }
+
+    static bool mapped(size_type n) {
+        return n * sizeof(T) >= hugePageSize;
+    }
+
+public:
+    template<typename U>
+    struct rebind
+    {
+        using other = HugePageAllocator<U>;
+    };
+
+    HugePageAllocator() = default;
+
+    template<typename U>
+    HugePageAllocator(const HugePageAllocator<U>&) noexcept {}
+
+    pointer allocate(size_type n) {
+        if (n > std::numeric_limits<size_type>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        if (!mapped(n)) {
+            return AlignedAllocator<T>{}.allocate(n);
+        }
+        void* ptr = ::mmap(nullptr, mappedSize(n), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+#ifdef MADV_HUGEPAGE
+        ::madvise(ptr, mappedSize(n), MADV_HUGEPAGE);
+#endif
+        return static_cast<pointer>(ptr);
+    }
+
+    void deallocate(pointer ptr, size_type n) noexcept {
+        if (!mapped(n)) {
+            AlignedAllocator<T>{}.deallocate(ptr, n);
+            return;
+        }
+        ::munmap(ptr, mappedSize(n));
+    }
+
+    template<typename U>
+    bool operator==(const HugePageAllocator<U>&) const noexcept {
+        return true;
+    }
+};
+
+} //namespace matrix
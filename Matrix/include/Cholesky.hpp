@@ -0,0 +1,183 @@
+#pragma once
+
+/*
+Class Cholesky<T>. Cholesky decomposition A = L L^T of a symmetric positive definite
+matrix, only the lower triangle of A is read. Blocked right-looking: a diagonal block
+of choleskyBlock columns is factorized directly, the panel below it is solved against
+it row by row in parallel, and the trailing lower triangle gets L21 L21^T subtracted by
+gemm, row blocks of the update are spread over the ThreadPool.
+The matrix is taken by value and factorized in its own storage, so Cholesky{std::move(a)}
+needs no copy. Functionality:
+    Cholesky(mtx)
+    size_type size()
+    bool positive()            - false if a non-positive pivot was met, L is then partial
+    value_type det()
+    std::vector<T> solve(b)    - throws std::runtime_error if the matrix isn't positive definite
+    const Matrix<T>& factor()  - L, zeros above the diagonal
+*/
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "Matrix.hpp"
+#include "Gemm.hpp"
+#include "ThreadPool.hpp"
+
+namespace matrix {
+
+inline constexpr std::size_t choleskyBlock = 64U;
+
+template<typename T>
+requires std::is_floating_point_v<T>
+class Cholesky final
+{
+    using value_type = T;
+    using size_type = std::size_t;
+
+    Matrix<value_type> l_;
+    bool positive_ = true;
+
+    //Unblocked factorization of the diagonal block at k0 of size nb.
+    bool factorDiagonal(size_type k0, size_type nb) {
+        auto a = l_.view();
+        for (size_type j = k0; j < k0 + nb; ++j) {
+            value_type diag = a(j, j);
+            for (size_type t = k0; t < j; ++t) {
+                diag -= a(j, t) * a(j, t);
+            }
+            if (!(diag > value_type{0})) {
+                return false;
+            }
+            diag = std::sqrt(diag);
+            a(j, j) = diag;
+            for (size_type i = j + 1; i < k0 + nb; ++i) {
+                value_type sum = a(i, j);
+                for (size_type t = k0; t < j; ++t) {
+                    sum -= a(i, t) * a(j, t);
+                }
+                a(i, j) = sum / diag;
+            }
+        }
+        return true;
+    }
+
+    //L21 <- A21 L11^-T, every row is an independent forward substitution.
+    void solvePanel(size_type k0, size_type nb) {
+        size_type n = l_.rows();
+        auto a = l_.view();
+        ThreadPool::instance().parallelFor(k0 + nb, n, [&] (size_type first, size_type last) {
+            for (size_type i = first; i < last; ++i) {
+                value_type* row = &a(i, 0);
+                for (size_type j = k0; j < k0 + nb; ++j) {
+                    const value_type* rowJ = &a(j, 0);
+                    value_type sum = row[j];
+                    for (size_type t = k0; t < j; ++t) {
+                        sum -= row[t] * rowJ[t];
+                    }
+                    row[j] = sum / rowJ[j];
+                }
+            }
+        }, std::max<size_type>(1U, choleskyBlock / nb));
+    }
+
+    //A22 -= L21 L21^T on the block lower triangle.
+    void updateTrailing(size_type k0, size_type nb) {
+        size_type n = l_.rows();
+        size_type start = k0 + nb;
+        size_type m = n - start;
+        auto a = l_.view();
+        Matrix<value_type> negL{m, nb, uninitialized};
+        Matrix<value_type> lt{nb, m, uninitialized};
+        for (size_type i = 0; i < m; ++i) {
+            for (size_type t = 0; t < nb; ++t) {
+                negL[i][t] = -a(start + i, k0 + t);
+                lt[t][i] = a(start + i, k0 + t);
+            }
+        }
+        size_type blocks = (m + choleskyBlock - 1U) / choleskyBlock;
+        ThreadPool::instance().parallelFor(0, blocks, [&] (size_type first, size_type last) {
+            for (size_type b = first; b < last; ++b) {
+                size_type i0 = b * choleskyBlock;
+                size_type i1 = std::min(m, i0 + choleskyBlock);
+                gemm<value_type>(negL.view().block(i0, 0, i1 - i0, nb), lt.view().block(0, 0, nb, i1),
+                                 a.block(start + i0, start, i1 - i0, i1));
+            }
+        });
+    }
+
+    void factorize() {
+        size_type n = l_.rows();
+        for (size_type k0 = 0; k0 < n; k0 += choleskyBlock) {
+            size_type nb = std::min(choleskyBlock, n - k0);
+            if (!factorDiagonal(k0, nb)) {
+                positive_ = false;
+                return;
+            }
+            if (k0 + nb < n) {
+                solvePanel(k0, nb);
+                updateTrailing(k0, nb);
+            }
+        }
+        for (size_type i = 0; i < n; ++i) {
+            std::fill(&l_[i][0] + i + 1, &l_[i][0] + n, value_type{0});
+        }
+    }
+
+public:
+    explicit Cholesky(Matrix<value_type> a):
+        l_(std::move(a)) {
+        if (!l_.square()) {
+            throw std::logic_error("Cholesky: matrix isn't square");
+        }
+        factorize();
+    }
+
+    size_type size() const {
+        return l_.rows();
+    }
+
+    bool positive() const {
+        return positive_;
+    }
+
+    value_type det() const {
+        if (!positive_) {
+            throw std::runtime_error("Cholesky: matrix isn't positive definite");
+        }
+        value_type det{1};
+        for (size_type i = 0; i < size(); ++i) {
+            det *= l_[i][i] * l_[i][i];
+        }
+        return det;
+    }
+
+    std::vector<value_type> solve(std::vector<value_type> b) const {
+        if (b.size() != size()) {
+            throw std::logic_error("Solve: sizes don't match");
+        }
+        if (!positive_) {
+            throw std::runtime_error("Solve: matrix isn't positive definite");
+        }
+        auto a = l_.view();
+        for (size_type i = 0; i < size(); ++i) {
+            value_type sum = b[i];
+            for (size_type j = 0; j < i; ++j) {
+                sum -= a(i, j) * b[j];
+            }
+            b[i] = sum / a(i, i);
+        }
+        for (size_type i = size(); i-- > 0;) {
+            b[i] /= a(i, i);
+            for (size_type j = 0; j < i; ++j) {
+                b[j] -= a(i, j) * b[i];
+            }
+        }
+        return b;
+    }
+
+    const Matrix<value_type>& factor() const {
+        return l_;
+    }
+};
+
+} //namespace matrix
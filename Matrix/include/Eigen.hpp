@@ -0,0 +1,403 @@
+#pragma once
+
+/*
+Symmetric eigensolver.
+
+Function symmetricEigen(A, vectors = true). Eigenvalues (ascending) and, optionally,
+eigenvectors of a symmetric matrix. Only the lower triangle of A is read.
+    1. Householder tridiagonalization Q^T A Q = T, blocked as in LAPACK sytrd/latrd:
+       a panel of eigenPanel reflectors is built with matrix-vector products only, and
+       the trailing matrix gets one rank-2*eigenPanel update A -= V W^T + W V^T by gemm.
+    2. Implicit QL with Wilkinson shifts on T (tql2). Rotations of one sweep are
+       recorded and then applied to the eigenvector rows in parallel by column slices.
+    3. Back-transformation x = Q z: each panel of eigenPanel reflectors is gathered into
+       compact WY form I - V T V^T (LAPACK larft) and applied to all eigenvectors at once
+       by two gemm calls, as in ormtr.
+Returns EigenResult: values, and vectors with eigenvector j in column j.
+
+Function eigenvalues(A). Eigenvalues only: tridiagonalization plus O(n^2) QL.
+*/
+
+#include <cmath>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include "Matrix.hpp"
+#include "Gemm.hpp"
+#include "ThreadPool.hpp"
+
+namespace matrix {
+
+inline constexpr std::size_t eigenPanel = 32U;
+inline constexpr std::size_t maxQLIterations = 60U;
+
+template<typename T>
+struct EigenResult
+{
+    std::vector<T> values;
+    Matrix<T> vectors;
+};
+
+namespace detail {
+
+template<typename T>
+struct Tridiagonal
+{
+    std::vector<T> d;
+    std::vector<T> e;
+    Matrix<T> reflectors; //row k holds v_k in columns k + 1.., v_k[k + 1] = 1
+    std::vector<T> taus;
+};
+
+//a is symmetric and full, it's destroyed
+template<typename T>
+Tridiagonal<T> tridiagonalize(Matrix<T>& mtx) {
+    std::size_t n = mtx.rows();
+    Tridiagonal<T> res{std::vector<T>(n), std::vector<T>(n), Matrix<T>{n, n}, std::vector<T>(n)};
+    auto a = mtx.view();
+    auto hv = res.reflectors.view();
+    ThreadPool& pool = ThreadPool::instance();
+
+    for (std::size_t k0 = 0; k0 + 1 < n; k0 += eigenPanel) {
+        std::size_t kEnd = std::min(k0 + eigenPanel, n - 1U);
+        std::size_t nb = kEnd - k0;
+        Matrix<T> vPanel{n, nb};
+        Matrix<T> wPanel{n, nb};
+        auto v = vPanel.view();
+        auto w = wPanel.view();
+        std::vector<T> y(n);
+        std::vector<T> vw(nb);
+        std::vector<T> vv(nb);
+
+        for (std::size_t k = k0; k < kEnd; ++k) {
+            std::size_t j = k - k0;
+            for (std::size_t i = k; i < n; ++i) {
+                T sum = T{0};
+                for (std::size_t t = 0; t < j; ++t) {
+                    sum += v(i, t) * w(k, t) + w(i, t) * v(k, t);
+                }
+                a(i, k) -= sum;
+            }
+            res.d[k] = a(k, k);
+
+            T alpha = a(k + 1, k);
+            T sigma = T{0};
+            for (std::size_t i = k + 2; i < n; ++i) {
+                sigma += a(i, k) * a(i, k);
+            }
+            T tau = T{0};
+            T beta = alpha;
+            v(k + 1, j) = T{1};
+            if (sigma != T{0}) {
+                T norm = std::sqrt(alpha * alpha + sigma);
+                beta = alpha <= T{0} ? norm : -norm;
+                tau = (beta - alpha) / beta;
+                T scale = T{1} / (alpha - beta);
+                for (std::size_t i = k + 2; i < n; ++i) {
+                    v(i, j) = a(i, k) * scale;
+                }
+            }
+            res.e[k] = beta;
+            res.taus[k] = tau;
+            for (std::size_t i = k + 1; i < n; ++i) {
+                hv(k, i) = v(i, j);
+            }
+            if (tau == T{0}) {
+                continue;
+            }
+
+            //y = A22 v with A22 as of the panel start, then the deferred corrections
+            pool.parallelFor(k + 1, n, [&] (std::size_t first, std::size_t last) {
+                for (std::size_t i = first; i < last; ++i) {
+                    const T* row = &a(i, 0);
+                    T sum = T{0};
+                    for (std::size_t l = k + 1; l < n; ++l) {
+                        sum += row[l] * v(l, j);
+                    }
+                    y[i] = sum;
+                }
+            }, std::max<std::size_t>(1U, (1U << 14U) / (n - k)));
+            for (std::size_t t = 0; t < j; ++t) {
+                vw[t] = T{0};
+                vv[t] = T{0};
+                for (std::size_t l = k + 1; l < n; ++l) {
+                    vw[t] += w(l, t) * v(l, j);
+                    vv[t] += v(l, t) * v(l, j);
+                }
+            }
+            T pv = T{0};
+            for (std::size_t i = k + 1; i < n; ++i) {
+                T sum = y[i];
+                for (std::size_t t = 0; t < j; ++t) {
+                    sum -= v(i, t) * vw[t] + w(i, t) * vv[t];
+                }
+                y[i] = tau * sum;
+                pv += y[i] * v(i, j);
+            }
+            T half = -tau / T{2} * pv;
+            for (std::size_t i = k + 1; i < n; ++i) {
+                w(i, j) = y[i] + half * v(i, j);
+            }
+        }
+
+        //A22 -= V W^T + W V^T on the trailing rows and columns
+        std::size_t m = n - kEnd;
+        if (m == 0U || nb == 0U) {
+            continue;
+        }
+        Matrix<T> negV{m, nb, uninitialized};
+        Matrix<T> negW{m, nb, uninitialized};
+        Matrix<T> vT{nb, m, uninitialized};
+        Matrix<T> wT{nb, m, uninitialized};
+        for (std::size_t i = 0; i < m; ++i) {
+            for (std::size_t t = 0; t < nb; ++t) {
+                negV[i][t] = -v(kEnd + i, t);
+                negW[i][t] = -w(kEnd + i, t);
+                vT[t][i] = v(kEnd + i, t);
+                wT[t][i] = w(kEnd + i, t);
+            }
+        }
+        auto trailing = a.block(kEnd, kEnd, m, m);
+        gemm<T>(negV.view(), wT.view(), trailing);
+        gemm<T>(negW.view(), vT.view(), trailing);
+    }
+    res.d[n - 1] = a(n - 1, n - 1);
+    res.e[n - 1] = T{0};
+    return res;
+}
+
+struct Rotation
+{
+    std::size_t i;
+    double c;
+    double s;
+};
+
+//rows i and i + 1 of z are rotated by every rotation, in order
+template<typename T>
+void applyRotations(MatrixView<T> z, const std::vector<Rotation>& rotations) {
+    if (rotations.empty()) {
+        return;
+    }
+    std::size_t n = z.cols();
+    ThreadPool::instance().parallelFor(0, n, [&] (std::size_t first, std::size_t last) {
+        for (const Rotation& rot: rotations) {
+            T* lo = &z(rot.i, 0);
+            T* hi = &z(rot.i + 1, 0);
+            T c = static_cast<T>(rot.c);
+            T s = static_cast<T>(rot.s);
+            for (std::size_t k = first; k < last; ++k) {
+                T f = hi[k];
+                hi[k] = s * lo[k] + c * f;
+                lo[k] = c * lo[k] - s * f;
+            }
+        }
+    }, std::max<std::size_t>(64U, (1U << 16U) / std::max<std::size_t>(1U, rotations.size())));
+}
+
+//Implicit QL on tridiagonal (d, e), e[i] couples i and i + 1. Rows of z are rotated along.
+template<typename T>
+void tridiagonalQL(std::vector<T>& d, std::vector<T>& e, Matrix<T>* z) {
+    std::size_t n = d.size();
+    std::vector<Rotation> rotations;
+    for (std::size_t l = 0; l < n; ++l) {
+        std::size_t iter = 0;
+        std::size_t m = l;
+        do {
+            for (m = l; m + 1 < n; ++m) {
+                T dd = std::abs(d[m]) + std::abs(d[m + 1]);
+                if (std::abs(e[m]) <= std::numeric_limits<T>::epsilon() * dd) {
+                    break;
+                }
+            }
+            if (m == l) {
+                break;
+            }
+            if (iter++ == maxQLIterations) {
+                throw std::runtime_error("Eigen: QL iterations don't converge");
+            }
+            T g = (d[l + 1] - d[l]) / (T{2} * e[l]);
+            T r = std::hypot(g, T{1});
+            g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+            T s = T{1};
+            T c = T{1};
+            T p = T{0};
+            bool deflated = false;
+            rotations.clear();
+            for (std::size_t i = m; i-- > l;) {
+                T f = s * e[i];
+                T b = c * e[i];
+                r = std::hypot(f, g);
+                e[i + 1] = r;
+                if (r == T{0}) {
+                    d[i + 1] -= p;
+                    e[m] = T{0};
+                    deflated = true;
+                    break;
+                }
+                s = f / r;
+                c = g / r;
+                g = d[i + 1] - p;
+                r = (d[i] - g) * s + T{2} * c * b;
+                p = s * r;
+                d[i + 1] = g + p;
+                g = c * r - b;
+                if (z != nullptr) {
+                    rotations.push_back(Rotation{i, static_cast<double>(c), static_cast<double>(s)});
+                }
+            }
+            if (z != nullptr) {
+                applyRotations(z->view(), rotations);
+            }
+            if (deflated) {
+                continue;
+            }
+            d[l] -= p;
+            e[l] = g;
+            e[m] = T{0};
+        } while (m != l);
+    }
+}
+
+//T of the forward block H_k0 ... H_k0+nb-1 = I - V T V^T, as in LAPACK larft.
+//vt is V^T: rows k0.. of the reflectors, columns k0 + 1..
+template<typename T>
+Matrix<T> reflectorBlockT(ConstMatrixView<T> vt, const std::vector<T>& taus) {
+    std::size_t nb = vt.rows();
+    std::size_t mm = vt.cols();
+    Matrix<T> tf{nb, nb};
+    std::vector<T> z(nb);
+    for (std::size_t i = 0; i < nb; ++i) {
+        T tau = taus[i];
+        tf[i][i] = tau;
+        for (std::size_t t = 0; t < i; ++t) {
+            T sum = T{0};
+            for (std::size_t r = i; r < mm; ++r) {
+                sum += vt(t, r) * vt(i, r);
+            }
+            z[t] = sum;
+        }
+        for (std::size_t t = 0; t < i; ++t) {
+            T sum = T{0};
+            for (std::size_t p = t; p < i; ++p) {
+                sum += tf[t][p] * z[p];
+            }
+            tf[t][i] = -tau * sum;
+        }
+    }
+    return tf;
+}
+
+//x columns are vectors in the tridiagonal basis, they become Q x = H_0 ... H_{n-2} x.
+//Blocks of eigenPanel reflectors are applied from the last one in compact WY form,
+//x -= V (T (V^T x)), with two gemm calls per block that run along the rows of x.
+template<typename T>
+void backTransform(const Tridiagonal<T>& tri, Matrix<T>& x) {
+    std::size_t n = x.rows();
+    if (n < 2U) {
+        return;
+    }
+    auto hv = tri.reflectors.view();
+    std::size_t k0 = (n - 2U) / eigenPanel * eigenPanel;
+    while (true) {
+        std::size_t nb = std::min(eigenPanel, n - 1U - k0);
+        std::size_t mm = n - 1U - k0;
+        auto vt = hv.block(k0, k0 + 1U, nb, mm);
+        Matrix<T> tf{reflectorBlockT<T>(vt, std::vector<T>(tri.taus.begin() + k0, tri.taus.begin() + k0 + nb))};
+        auto xBlock = x.view().block(k0 + 1U, 0, mm, n);
+        Matrix<T> w{nb, n};
+        gemm<T>(vt, xBlock, w.view());
+        Matrix<T> tw{nb, n}; //-T W, so that the second gemm subtracts
+        ThreadPool::instance().parallelFor(0, nb, [&] (std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                for (std::size_t p = i; p < nb; ++p) {
+                    T coef = tf[i][p];
+                    if (coef == T{0}) {
+                        continue;
+                    }
+                    const T* src = &w[p][0];
+                    T* dst = &tw[i][0];
+                    for (std::size_t j = 0; j < n; ++j) {
+                        dst[j] -= coef * src[j];
+                    }
+                }
+            }
+        });
+        Matrix<T> v{mm, nb, uninitialized};
+        for (std::size_t r = 0; r < mm; ++r) {
+            for (std::size_t t = 0; t < nb; ++t) {
+                v[r][t] = vt(t, r);
+            }
+        }
+        gemm<T>(v.view(), tw.view(), xBlock);
+        if (k0 == 0U) {
+            break;
+        }
+        k0 -= eigenPanel;
+    }
+}
+
+template<typename T, typename A>
+Matrix<T> symmetrized(const Matrix<T, A>& mtx) {
+    if (!mtx.square()) {
+        throw std::logic_error("Eigen: matrix isn't square");
+    }
+    if (mtx.empty()) {
+        throw std::logic_error("Eigen: matrix is empty");
+    }
+    std::size_t n = mtx.rows();
+    Matrix<T> res{n, n, uninitialized};
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j <= i; ++j) {
+            res[i][j] = mtx[i][j];
+            res[j][i] = mtx[i][j];
+        }
+    }
+    return res;
+}
+
+} //namespace detail
+
+template<typename T, typename A>
+EigenResult<T> symmetricEigen(const Matrix<T, A>& mtx, bool vectors = true) requires std::is_floating_point_v<T> {
+    Matrix<T> a{detail::symmetrized<T>(mtx)};
+    std::size_t n = a.rows();
+    detail::Tridiagonal<T> tri{detail::tridiagonalize(a)};
+    a = Matrix<T>{};
+    if (!vectors) {
+        detail::tridiagonalQL<T>(tri.d, tri.e, nullptr);
+        std::sort(tri.d.begin(), tri.d.end());
+        return EigenResult<T>{std::move(tri.d), Matrix<T>{}};
+    }
+    Matrix<T> z{Matrix<T>::eye(n, T{1})};
+    detail::tridiagonalQL<T>(tri.d, tri.e, &z);
+    Matrix<T> x{n, n, uninitialized};
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+            x[i][j] = z[j][i];
+        }
+    }
+    z = Matrix<T>{};
+    detail::backTransform(tri, x);
+
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::sort(order.begin(), order.end(), [&tri] (std::size_t lhs, std::size_t rhs) {
+        return tri.d[lhs] < tri.d[rhs];
+    });
+    EigenResult<T> res{std::vector<T>(n), Matrix<T>{n, n, uninitialized}};
+    for (std::size_t j = 0; j < n; ++j) {
+        res.values[j] = tri.d[order[j]];
+        for (std::size_t i = 0; i < n; ++i) {
+            res.vectors[i][j] = x[i][order[j]];
+        }
+    }
+    return res;
+}
+
+template<typename T, typename A>
+std::vector<T> eigenvalues(const Matrix<T, A>& mtx) requires std::is_floating_point_v<T> {
+    return symmetricEigen(mtx, false).values;
+}
+
+} //namespace matrix
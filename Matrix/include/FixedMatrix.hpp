@@ -0,0 +1,422 @@
+#pragma once
+
+/*
+Class FixedMatrix<T, M, N>. Matrix with compile-time dimensions stored on the stack.
+Every operation is constexpr, loops have constant trip counts and get unrolled.
+Functionality:
+    operator[]                  - row, std::array<T, N>
+    value_type at(i, j)         - bounds-checked access
+    static rows(), cols()
+    static eye(value)
+    value_type det()            - closed form for N <= 4, otherwise Gauss elimination for
+                                  floating point and fraction-free Bareiss for integral T:
+                                  128-bit intermediates, every product is checked, so the
+                                  result is exact or std::overflow_error is thrown, also
+                                  when the determinant doesn't fit in T
+    FixedMatrix inverse()       - closed form (adjugate) for floating point N <= 4
+    FixedMatrix<T, N, M> transposed()
+    operator+=, operator-=, operator*=(value), operator/=(value)
+    Interoperability: FixedMatrix(const Matrix&), FixedMatrix(ConstMatrixView), toMatrix(), view()
+
+Function detBatch(span<const FixedMatrix<T, N, N>>, span<T>). Determinants of many small
+matrices: matrices are regrouped by batchLanes into SoA layout (element (i, j) of every
+matrix of the group is contiguous) and the closed form is evaluated across the group,
+so the lane loop vectorizes.
+*/
+
+#include <span>
+#include <array>
+#include <limits>
+#include <cstddef>
+#include <utility>
+#include <stdexcept>
+#include <type_traits>
+#include <initializer_list>
+#include "Matrix.hpp"
+
+namespace matrix {
+
+template<typename T, std::size_t M, std::size_t N>
+class FixedMatrix final
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using Row = std::array<value_type, N>;
+
+private:
+    std::array<Row, M> data_{};
+
+    template<typename Get>
+    static constexpr value_type det2(Get a, size_type r0, size_type r1, size_type c0, size_type c1) {
+        return a(r0, c0) * a(r1, c1) - a(r0, c1) * a(r1, c0);
+    }
+
+    template<typename Get>
+    static constexpr value_type det3(Get a) {
+        return a(0, 0) * det2(a, 1, 2, 1, 2) - a(0, 1) * det2(a, 1, 2, 0, 2) + a(0, 2) * det2(a, 1, 2, 0, 1);
+    }
+
+    template<typename Get>
+    static constexpr value_type det4(Get a) {
+        value_type s0 = det2(a, 0, 1, 0, 1);
+        value_type s1 = det2(a, 0, 1, 0, 2);
+        value_type s2 = det2(a, 0, 1, 0, 3);
+        value_type s3 = det2(a, 0, 1, 1, 2);
+        value_type s4 = det2(a, 0, 1, 1, 3);
+        value_type s5 = det2(a, 0, 1, 2, 3);
+        value_type c5 = det2(a, 2, 3, 2, 3);
+        value_type c4 = det2(a, 2, 3, 1, 3);
+        value_type c3 = det2(a, 2, 3, 1, 2);
+        value_type c2 = det2(a, 2, 3, 0, 3);
+        value_type c1 = det2(a, 2, 3, 0, 2);
+        value_type c0 = det2(a, 2, 3, 0, 1);
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+
+    constexpr value_type detGauss() const {
+        FixedMatrix mtx{*this};
+        value_type det = value_type{1};
+        for (size_type k = 0; k < N; ++k) {
+            size_type pivot = k;
+            for (size_type i = k + 1; i < N; ++i) {
+                if (abs(mtx.data_[i][k]) > abs(mtx.data_[pivot][k])) {
+                    pivot = i;
+                }
+            }
+            if (mtx.data_[pivot][k] == value_type{0}) {
+                return value_type{0};
+            }
+            if (pivot != k) {
+                std::swap(mtx.data_[pivot], mtx.data_[k]);
+                det = -det;
+            }
+            det *= mtx.data_[k][k];
+            for (size_type i = k + 1; i < N; ++i) {
+                value_type coef = mtx.data_[i][k] / mtx.data_[k][k];
+                for (size_type j = k; j < N; ++j) {
+                    mtx.data_[i][j] -= coef * mtx.data_[k][j];
+                }
+            }
+        }
+        return det;
+    }
+
+    //Every division of Bareiss elimination is exact. Products and differences are checked
+    //against the i128 range and the result against the range of value_type.
+    constexpr value_type detBareiss() const requires std::is_integral_v<value_type> {
+        std::array<std::array<i128, N>, N> mtx{};
+        for (size_type i = 0; i < N; ++i) {
+            for (size_type j = 0; j < N; ++j) {
+                mtx[i][j] = data_[i][j];
+            }
+        }
+        i128 sign = 1;
+        i128 prev = 1;
+        for (size_type k = 0; k + 1 < N; ++k) {
+            size_type pivot = k;
+            while (pivot < N && mtx[pivot][k] == 0) {
+                pivot++;
+            }
+            if (pivot == N) {
+                return value_type{0};
+            }
+            if (pivot != k) {
+                std::swap(mtx[pivot], mtx[k]);
+                sign = -sign;
+            }
+            for (size_type i = k + 1; i < N; ++i) {
+                for (size_type j = k + 1; j < N; ++j) {
+                    i128 lhs = 0;
+                    i128 rhs = 0;
+                    i128 diff = 0;
+                    if (__builtin_mul_overflow(mtx[k][k], mtx[i][j], &lhs) ||
+                        __builtin_mul_overflow(mtx[i][k], mtx[k][j], &rhs) ||
+                        __builtin_sub_overflow(lhs, rhs, &diff)) {
+                        throw std::overflow_error("Det: Bareiss product doesn't fit in 128 bits");
+                    }
+                    mtx[i][j] = diff / prev;
+                }
+            }
+            prev = mtx[k][k];
+        }
+        i128 res = sign * mtx[N - 1][N - 1];
+        if (res < static_cast<i128>(std::numeric_limits<value_type>::min()) ||
+            res > static_cast<i128>(std::numeric_limits<value_type>::max())) {
+            throw std::overflow_error("Det: result doesn't fit in value type");
+        }
+        return static_cast<value_type>(res);
+    }
+
+    static constexpr value_type abs(const value_type& value) {
+        return value < value_type{0} ? -value : value;
+    }
+
+public:
+    template<typename Get>
+    static constexpr value_type detClosedForm(Get a) requires (M == N && N <= 4) {
+        if constexpr (N == 0) {
+            return value_type{1};
+        } else if constexpr (N == 1) {
+            return a(0, 0);
+        } else if constexpr (N == 2) {
+            return det2(a, 0, 1, 0, 1);
+        } else if constexpr (N == 3) {
+            return det3(a);
+        } else {
+            return det4(a);
+        }
+    }
+
+    constexpr FixedMatrix() = default;
+
+    constexpr FixedMatrix(std::initializer_list<std::initializer_list<value_type>> lst) {
+        size_type i = 0U;
+        for (const auto& nestedLst: lst) {
+            if (i == M) {
+                break;
+            }
+            size_type j = 0U;
+            for (const auto& elem: nestedLst) {
+                if (j == N) {
+                    break;
+                }
+                data_[i][j++] = elem;
+            }
+            i++;
+        }
+    }
+
+    template<typename U>
+    requires std::is_same_v<std::remove_const_t<U>, value_type>
+    explicit FixedMatrix(MatrixView<U> view) {
+        if (view.rows() != M || view.cols() != N) {
+            throw std::logic_error("FixedMatrix: sizes don't match");
+        }
+        for (size_type i = 0; i < M; ++i) {
+            for (size_type j = 0; j < N; ++j) {
+                data_[i][j] = view(i, j);
+            }
+        }
+    }
+
+    template<typename A>
+    explicit FixedMatrix(const Matrix<value_type, A>& mtx):
+        FixedMatrix(mtx.view()) {}
+
+    static constexpr FixedMatrix eye(const value_type& val) requires (M == N) {
+        FixedMatrix res;
+        for (size_type i = 0; i < N; ++i) {
+            res.data_[i][i] = val;
+        }
+        return res;
+    }
+
+    static constexpr size_type rows() {
+        return M;
+    }
+
+    static constexpr size_type cols() {
+        return N;
+    }
+
+    constexpr Row& operator[](size_type indx) {
+        return data_[indx];
+    }
+
+    constexpr const Row& operator[](size_type indx) const {
+        return data_[indx];
+    }
+
+    constexpr value_type at(size_type i, size_type j) const {
+        if (i >= M || j >= N) {
+            throw std::out_of_range("At: index is out of range");
+        }
+        return data_[i][j];
+    }
+
+    MatrixView<value_type> view() {
+        return MatrixView<value_type>{data_[0].data(), M, N, N};
+    }
+
+    ConstMatrixView<value_type> view() const {
+        return ConstMatrixView<value_type>{data_[0].data(), M, N, N};
+    }
+
+    Matrix<value_type> toMatrix() const {
+        return Matrix<value_type>{view()};
+    }
+
+    bool operator==(const FixedMatrix& rhs) const {
+        for (size_type i = 0; i < M; ++i) {
+            for (size_type j = 0; j < N; ++j) {
+                if (!::matrix::equals(data_[i][j], rhs.data_[i][j])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool operator!=(const FixedMatrix& rhs) const {
+        return !(*this == rhs);
+    }
+
+    constexpr value_type det() const requires (M == N) {
+        if constexpr (N <= 4) {
+            return detClosedForm([this] (size_type i, size_type j) { return data_[i][j]; });
+        } else if constexpr (std::is_integral_v<value_type>) {
+            return detBareiss();
+        } else {
+            return detGauss();
+        }
+    }
+
+    constexpr FixedMatrix inverse() const requires (M == N && N >= 1 && N <= 4 && std::is_floating_point_v<value_type>) {
+        value_type det = this->det();
+        if (det == value_type{0}) {
+            throw std::logic_error("Inverse: matrix is singular");
+        }
+        FixedMatrix res;
+        for (size_type i = 0; i < N; ++i) {
+            for (size_type j = 0; j < N; ++j) {
+                //adjugate: res[i][j] = (-1)^(i+j) * minor(j, i)
+                auto minor = [this, i, j] (size_type r, size_type c) {
+                    return data_[r < j ? r : r + 1][c < i ? c : c + 1];
+                };
+                value_type cofactor = FixedMatrix<value_type, N - 1, N - 1>::detClosedForm(minor);
+                res.data_[i][j] = ((i + j) % 2 == 0 ? cofactor : -cofactor) / det;
+            }
+        }
+        return res;
+    }
+
+    constexpr FixedMatrix<value_type, N, M> transposed() const {
+        FixedMatrix<value_type, N, M> res;
+        for (size_type i = 0; i < M; ++i) {
+            for (size_type j = 0; j < N; ++j) {
+                res[j][i] = data_[i][j];
+            }
+        }
+        return res;
+    }
+
+    constexpr FixedMatrix& operator+=(const FixedMatrix& rhs) {
+        for (size_type i = 0; i < M; ++i) {
+            for (size_type j = 0; j < N; ++j) {
+                data_[i][j] += rhs.data_[i][j];
+            }
+        }
+        return *this;
+    }
+
+    constexpr FixedMatrix& operator-=(const FixedMatrix& rhs) {
+        for (size_type i = 0; i < M; ++i) {
+            for (size_type j = 0; j < N; ++j) {
+                data_[i][j] -= rhs.data_[i][j];
+            }
+        }
+        return *this;
+    }
+
+    constexpr FixedMatrix& operator*=(const value_type& rhs) {
+        for (auto& row: data_) {
+            for (auto& elem: row) {
+                elem *= rhs;
+            }
+        }
+        return *this;
+    }
+
+    constexpr FixedMatrix& operator/=(const value_type& rhs) {
+        for (auto& row: data_) {
+            for (auto& elem: row) {
+                elem /= rhs;
+            }
+        }
+        return *this;
+    }
+};
+
+template<typename T, std::size_t M, std::size_t N>
+std::ostream& operator<<(std::ostream& os, const FixedMatrix<T, M, N>& mtx)
+{
+    return os << mtx.view();
+}
+
+template<typename T, std::size_t M, std::size_t N>
+constexpr FixedMatrix<T, M, N> operator+(const FixedMatrix<T, M, N>& lhs, const FixedMatrix<T, M, N>& rhs) {
+    FixedMatrix<T, M, N> res{lhs};
+    res+=rhs;
+    return res;
+}
+
+template<typename T, std::size_t M, std::size_t N>
+constexpr FixedMatrix<T, M, N> operator-(const FixedMatrix<T, M, N>& lhs, const FixedMatrix<T, M, N>& rhs) {
+    FixedMatrix<T, M, N> res{lhs};
+    res-=rhs;
+    return res;
+}
+
+template<typename T, std::size_t M, std::size_t N>
+constexpr FixedMatrix<T, M, N> operator*(const FixedMatrix<T, M, N>& lhs, const T& rhs) {
+    FixedMatrix<T, M, N> res{lhs};
+    res*=rhs;
+    return res;
+}
+
+template<typename T, std::size_t M, std::size_t N>
+constexpr FixedMatrix<T, M, N> operator*(const T& lhs, const FixedMatrix<T, M, N>& rhs) {
+    FixedMatrix<T, M, N> res{rhs};
+    res*=lhs;
+    return res;
+}
+
+template<typename T, std::size_t M, std::size_t N>
+constexpr FixedMatrix<T, M, N> operator/(const FixedMatrix<T, M, N>& lhs, const T& rhs) {
+    FixedMatrix<T, M, N> res{lhs};
+    res/=rhs;
+    return res;
+}
+
+template<typename T, std::size_t M, std::size_t K, std::size_t N>
+constexpr FixedMatrix<T, M, N> operator*(const FixedMatrix<T, M, K>& lhs, const FixedMatrix<T, K, N>& rhs) {
+    FixedMatrix<T, M, N> res;
+    for (std::size_t i = 0; i < M; ++i) {
+        for (std::size_t k = 0; k < K; ++k) {
+            for (std::size_t j = 0; j < N; ++j) {
+                res[i][j] += lhs[i][k] * rhs[k][j];
+            }
+        }
+    }
+    return res;
+}
+
+inline constexpr std::size_t batchLanes = 16U;
+
+template<typename T, std::size_t N>
+void detBatch(std::span<const FixedMatrix<T, N, N>> mtxs, std::span<T> dets) requires (N >= 1 && N <= 4) {
+    if (mtxs.size() != dets.size()) {
+        throw std::logic_error("DetBatch: sizes don't match");
+    }
+    alignas(cacheLineSize) T soa[N * N][batchLanes]{};
+    for (std::size_t first = 0; first < mtxs.size(); first += batchLanes) {
+        std::size_t count = std::min(batchLanes, mtxs.size() - first);
+        for (std::size_t l = 0; l < count; ++l) {
+            for (std::size_t i = 0; i < N; ++i) {
+                for (std::size_t j = 0; j < N; ++j) {
+                    soa[i * N + j][l] = mtxs[first + l][i][j];
+                }
+            }
+        }
+        T res[batchLanes];
+        for (std::size_t l = 0; l < batchLanes; ++l) {
+            res[l] = FixedMatrix<T, N, N>::detClosedForm([&soa, l] (std::size_t i, std::size_t j) {
+                return soa[i * N + j][l];
+            });
+        }
+        std::copy_n(res, count, dets.begin() + first);
+    }
+}
+
+} //namespace matrix
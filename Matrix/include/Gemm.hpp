@@ -0,0 +1,94 @@
+#pragma once
+
+/*
+Function gemm(a, b, c). c += a * b for matrix views of any strides.
+
+Views with unit column stride go through the blocked kernel: rows of c are split into
+gemmBlockM-row panels, which are distributed over the ThreadPool; inside a panel the
+k and j loops are tiled by gemmBlockK x gemmBlockN, so the slice of b in use stays in
+cache, and the innermost loop runs over contiguous rows of b and c.
+
+Function gemv(a, x, y). y += a * x, rows of a are distributed over the ThreadPool.
+*/
+
+#include <span>
+#include <algorithm>
+#include "MatrixView.hpp"
+#include "ThreadPool.hpp"
+
+namespace matrix {
+
+inline constexpr std::size_t gemmBlockM = 32U;
+inline constexpr std::size_t gemmBlockK = 256U;
+inline constexpr std::size_t gemmBlockN = 512U;
+
+template<typename T>
+void gemm(ConstMatrixView<T> a, ConstMatrixView<T> b, MatrixView<T> c) {
+    if (a.cols() != b.rows() || a.rows() != c.rows() || b.cols() != c.cols()) {
+        throw std::logic_error("Gemm: sizes don't match");
+    }
+    std::size_t m = a.rows();
+    std::size_t k = a.cols();
+    std::size_t n = b.cols();
+    if (b.colStride() != 1U || c.colStride() != 1U) {
+        for (std::size_t i = 0; i < m; ++i) {
+            for (std::size_t p = 0; p < k; ++p) {
+                const T aip = a(i, p);
+                for (std::size_t j = 0; j < n; ++j) {
+                    c(i, j) += aip * b(p, j);
+                }
+            }
+        }
+        return;
+    }
+    std::size_t nPanels = (m + gemmBlockM - 1U) / gemmBlockM;
+    std::size_t minPanels = std::max<std::size_t>(1U, (1U << 16U) / std::max<std::size_t>(1U, k * n / gemmBlockM));
+    ThreadPool::instance().parallelFor(0, nPanels, [&] (std::size_t first, std::size_t last) {
+        for (std::size_t panel = first; panel < last; ++panel) {
+            std::size_t iBegin = panel * gemmBlockM;
+            std::size_t iEnd = std::min(iBegin + gemmBlockM, m);
+            for (std::size_t pp = 0; pp < k; pp += gemmBlockK) {
+                std::size_t pEnd = std::min(pp + gemmBlockK, k);
+                for (std::size_t jj = 0; jj < n; jj += gemmBlockN) {
+                    std::size_t jEnd = std::min(jj + gemmBlockN, n);
+                    for (std::size_t i = iBegin; i < iEnd; ++i) {
+                        T* crow = c.data() + i * c.rowStride();
+                        for (std::size_t p = pp; p < pEnd; ++p) {
+                            const T aip = a(i, p);
+                            const T* brow = b.data() + p * b.rowStride();
+                            for (std::size_t j = jj; j < jEnd; ++j) {
+                                crow[j] += aip * brow[j];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }, minPanels);
+}
+
+template<typename T>
+void gemv(ConstMatrixView<T> a, std::span<const T> x, std::span<T> y) {
+    if (a.cols() != x.size() || a.rows() != y.size()) {
+        throw std::logic_error("Gemv: sizes don't match");
+    }
+    std::size_t minRows = std::max<std::size_t>(1U, (1U << 14U) / std::max<std::size_t>(1U, a.cols()));
+    ThreadPool::instance().parallelFor(0, a.rows(), [&] (std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            T sum = T{};
+            if (a.colStride() == 1U) {
+                const T* row = a.data() + i * a.rowStride();
+                for (std::size_t j = 0; j < x.size(); ++j) {
+                    sum += row[j] * x[j];
+                }
+            } else {
+                for (std::size_t j = 0; j < x.size(); ++j) {
+                    sum += a(i, j) * x[j];
+                }
+            }
+            y[i] += sum;
+        }
+    }, minRows);
+}
+
+} //namespace matrix
@@ -0,0 +1,160 @@
+#pragma once
+
+/*
+Class LU<T>. LU decomposition with partial pivoting, PA = LU, L has unit diagonal and
+is stored below the diagonal of U. The trailing update walks contiguous rows, so the
+inner loop vectorizes, and rows of the update are distributed over the ThreadPool.
+Functionality:
+    LU(view)                   - factorizes a copy, converting elements to T
+    size_type size()
+    bool singular()            - zero pivot met
+    bool finite()              - no inf/nan appeared, e.g. from float overflow
+    value_type det()
+    std::vector<T> solve(b)    - throws std::runtime_error if the matrix is singular
+    const Matrix<T>& factors()
+    const std::vector<size_type>& permutation() - row i of PA is row permutation()[i] of A
+*/
+
+#include <cmath>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include "Matrix.hpp"
+#include "ThreadPool.hpp"
+
+namespace matrix {
+
+template<typename T>
+requires std::is_floating_point_v<T>
+class LU final
+{
+    using value_type = T;
+    using size_type = std::size_t;
+
+    static constexpr size_type minParallelWork = 1U << 14U;
+
+    Matrix<value_type> lu_;
+    std::vector<size_type> perm_;
+    bool odd_ = false;
+    bool singular_ = false;
+
+    void factorize() {
+        size_type n = lu_.rows();
+        auto a = lu_.view();
+        for (size_type k = 0; k < n; ++k) {
+            size_type pivot = k;
+            for (size_type i = k + 1; i < n; ++i) {
+                if (std::abs(a(i, k)) > std::abs(a(pivot, k))) {
+                    pivot = i;
+                }
+            }
+            if (pivot != k) {
+                std::swap_ranges(&a(k, 0), &a(k, 0) + n, &a(pivot, 0));
+                std::swap(perm_[k], perm_[pivot]);
+                odd_ = !odd_;
+            }
+            if (a(k, k) == value_type{0}) {
+                singular_ = true;
+                continue;
+            }
+            const value_type inv = value_type{1} / a(k, k);
+            const value_type* rowK = &a(k, 0);
+            size_type minChunk = std::max<size_type>(1U, minParallelWork / (n - k));
+            ThreadPool::instance().parallelFor(k + 1, n, [&] (size_type first, size_type last) {
+                for (size_type i = first; i < last; ++i) {
+                    value_type* rowI = &a(i, 0);
+                    value_type coef = rowI[k] * inv;
+                    rowI[k] = coef;
+                    for (size_type j = k + 1; j < n; ++j) {
+                        rowI[j] -= coef * rowK[j];
+                    }
+                }
+            }, minChunk);
+        }
+    }
+
+public:
+    template<typename U>
+    explicit LU(MatrixView<U> a):
+        lu_(a.rows(), a.cols(), uninitialized), perm_(a.rows()) {
+        if (!a.square()) {
+            throw std::logic_error("LU: matrix isn't square");
+        }
+        for (size_type i = 0; i < a.rows(); ++i) {
+            for (size_type j = 0; j < a.cols(); ++j) {
+                lu_[i][j] = static_cast<value_type>(a(i, j));
+            }
+        }
+        std::iota(perm_.begin(), perm_.end(), size_type{0});
+        factorize();
+    }
+
+    template<typename U, typename A>
+    explicit LU(const Matrix<U, A>& a):
+        LU(a.view()) {}
+
+    size_type size() const {
+        return lu_.rows();
+    }
+
+    bool singular() const {
+        return singular_;
+    }
+
+    bool finite() const {
+        auto a = lu_.view();
+        for (size_type i = 0; i < size(); ++i) {
+            for (size_type j = 0; j < size(); ++j) {
+                if (!std::isfinite(a(i, j))) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    value_type det() const {
+        value_type det = odd_ ? value_type{-1} : value_type{1};
+        for (size_type i = 0; i < size(); ++i) {
+            det *= lu_[i][i];
+        }
+        return det;
+    }
+
+    template<typename U>
+    std::vector<value_type> solve(const std::vector<U>& b) const {
+        if (b.size() != size()) {
+            throw std::logic_error("Solve: sizes don't match");
+        }
+        if (singular_) {
+            throw std::runtime_error("Solve: matrix is singular");
+        }
+        auto a = lu_.view();
+        std::vector<value_type> x(size());
+        for (size_type i = 0; i < size(); ++i) {
+            value_type sum = static_cast<value_type>(b[perm_[i]]);
+            for (size_type j = 0; j < i; ++j) {
+                sum -= a(i, j) * x[j];
+            }
+            x[i] = sum;
+        }
+        for (size_type i = size(); i-- > 0;) {
+            value_type sum = x[i];
+            for (size_type j = i + 1; j < size(); ++j) {
+                sum -= a(i, j) * x[j];
+            }
+            x[i] = sum / a(i, i);
+        }
+        return x;
+    }
+
+    const Matrix<value_type>& factors() const {
+        return lu_;
+    }
+
+    const std::vector<size_type>& permutation() const {
+        return perm_;
+    }
+};
+
+} //namespace matrix
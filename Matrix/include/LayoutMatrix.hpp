@@ -0,0 +1,503 @@
+#pragma once
+
+/*
+Class LayoutMatrix<T, L>. Dense matrix with a chosen memory layout. Matrix stays
+row-major, since its rows, views and row swaps are built on that; LayoutMatrix is for
+algorithms that walk columns or blocks. Layout policies map (i, j) to an offset:
+    RowMajorLayout
+    ColMajorLayout
+    MortonLayout<Tile> - Tile x Tile row-major tiles (64 by default) stored in Z-order
+                         of tile indices, so every quadrant of tiles is close in memory.
+                         Edge tiles are zero padded to full size.
+Functionality:
+    LayoutMatrix(rows, cols), LayoutMatrix(matrix), LayoutMatrix(other layout)
+    size_type rows(), cols()
+    reference operator()(i, j)
+    Matrix toMatrix()
+    MatrixView tile(bi, bj)     - MortonLayout only, contiguous Tile x Tile block
+    operators +=, -=, *= (scalar), *= (matrix), ==, !=, + - * of any two layouts,
+        result has the layout of the left operand
+    transpose()                 - in place for square, tiles are transposed one by one
+    factorizeLU()               - MortonLayout and floating point only: PA = LU in place,
+                                  L has unit diagonal and is stored below U; returns the
+                                  swaps, row g was swapped with row pivots[g]
+    value_type det()            - MortonLayout and floating point only, through factorizeLU
+
+Products run through gemm: row-major directly, column-major as the row-major product
+B^T A^T of the same buffers, Morton tile by tile on contiguous tiles. LU on Morton is
+right-looking by tile columns: the panel is factorized with partial pivoting, the U
+tiles of its row are solved with the unit lower tile, and every trailing tile gets one
+gemm on contiguous tiles. Strassen isn't ported to LayoutMatrix: products of any layout
+are the tiled gemm above; Matrix keeps Strassen.
+*/
+
+#include <cmath>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include "Matrix.hpp"
+#include "Gemm.hpp"
+#include "ThreadPool.hpp"
+
+namespace matrix {
+
+class RowMajorLayout final
+{
+    using size_type = std::size_t;
+
+    size_type cols_ = 0U;
+    size_type size_ = 0U;
+
+public:
+    RowMajorLayout(size_type rows, size_type cols):
+        cols_(cols), size_(rows * cols) {}
+
+    size_type size() const {
+        return size_;
+    }
+
+    size_type offset(size_type i, size_type j) const {
+        return i * cols_ + j;
+    }
+};
+
+class ColMajorLayout final
+{
+    using size_type = std::size_t;
+
+    size_type rows_ = 0U;
+    size_type size_ = 0U;
+
+public:
+    ColMajorLayout(size_type rows, size_type cols):
+        rows_(rows), size_(rows * cols) {}
+
+    size_type size() const {
+        return size_;
+    }
+
+    size_type offset(size_type i, size_type j) const {
+        return j * rows_ + i;
+    }
+};
+
+template<std::size_t Tile = 64U>
+class MortonLayout final
+{
+    using size_type = std::size_t;
+
+    size_type tileRows_ = 0U;
+    size_type tileCols_ = 0U;
+    std::vector<size_type> slots_; //position of tile (bi, bj) in Z-order
+
+    static size_type spread(size_type x) {
+        size_type res = 0U;
+        for (size_type bit = 0; bit < 32U; ++bit) {
+            res |= ((x >> bit) & 1U) << (2U * bit);
+        }
+        return res;
+    }
+
+public:
+    static constexpr size_type tile = Tile;
+
+    MortonLayout(size_type rows, size_type cols):
+        tileRows_((rows + Tile - 1U) / Tile), tileCols_((cols + Tile - 1U) / Tile), slots_(tileRows_ * tileCols_) {
+        std::vector<size_type> codes(slots_.size());
+        for (size_type bi = 0; bi < tileRows_; ++bi) {
+            for (size_type bj = 0; bj < tileCols_; ++bj) {
+                codes[bi * tileCols_ + bj] = (spread(bi) << 1U) | spread(bj);
+            }
+        }
+        std::vector<size_type> order(slots_.size());
+        std::iota(order.begin(), order.end(), size_type{0});
+        std::sort(order.begin(), order.end(), [&codes] (size_type lhs, size_type rhs) {
+            return codes[lhs] < codes[rhs];
+        });
+        for (size_type slot = 0; slot < order.size(); ++slot) {
+            slots_[order[slot]] = slot;
+        }
+    }
+
+    size_type size() const {
+        return slots_.size() * Tile * Tile;
+    }
+
+    size_type tileRows() const {
+        return tileRows_;
+    }
+
+    size_type tileCols() const {
+        return tileCols_;
+    }
+
+    size_type tileOffset(size_type bi, size_type bj) const {
+        return slots_[bi * tileCols_ + bj] * Tile * Tile;
+    }
+
+    size_type offset(size_type i, size_type j) const {
+        return tileOffset(i / Tile, j / Tile) + (i % Tile) * Tile + j % Tile;
+    }
+};
+
+template<typename L>
+inline constexpr bool isMortonLayout = false;
+
+template<std::size_t Tile>
+inline constexpr bool isMortonLayout<MortonLayout<Tile>> = true;
+
+template<typename T, typename L = RowMajorLayout>
+class LayoutMatrix final
+{
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T &;
+    using const_reference = const T &;
+
+    template<typename U, typename L2>
+    friend class LayoutMatrix;
+
+    size_type m_ = 0U;
+    size_type n_ = 0U;
+    L layout_;
+    Storage<value_type> buffer_;
+
+    template<typename L2>
+    void assign(const LayoutMatrix<value_type, L2>& rhs) {
+        for (size_type i = 0; i < m_; ++i) {
+            for (size_type j = 0; j < n_; ++j) {
+                (*this)(i, j) = rhs(i, j);
+            }
+        }
+    }
+
+    //this = lhs * rhs, all three of layout L and zero filled this.
+    void multiply(const LayoutMatrix& lhs, const LayoutMatrix& rhs) {
+        if constexpr (std::is_same_v<L, RowMajorLayout>) {
+            gemm<value_type>(ConstMatrixView<value_type>{lhs.data(), lhs.m_, lhs.n_, lhs.n_},
+                             ConstMatrixView<value_type>{rhs.data(), rhs.m_, rhs.n_, rhs.n_},
+                             MatrixView<value_type>{data(), m_, n_, n_});
+        } else if constexpr (std::is_same_v<L, ColMajorLayout>) {
+            gemm<value_type>(ConstMatrixView<value_type>{rhs.data(), rhs.n_, rhs.m_, rhs.m_},
+                             ConstMatrixView<value_type>{lhs.data(), lhs.n_, lhs.m_, lhs.m_},
+                             MatrixView<value_type>{data(), n_, m_, m_});
+        } else if constexpr (isMortonLayout<L>) {
+            size_type nk = lhs.layout_.tileCols();
+            size_type ni = layout_.tileRows();
+            size_type nj = layout_.tileCols();
+            ThreadPool::instance().parallelFor(0, ni * nj, [&] (size_type first, size_type last) {
+                for (size_type t = first; t < last; ++t) {
+                    auto dst = tile(t / nj, t % nj);
+                    for (size_type bk = 0; bk < nk; ++bk) {
+                        gemm<value_type>(lhs.tile(t / nj, bk), rhs.tile(bk, t % nj), dst);
+                    }
+                }
+            });
+        } else {
+            for (size_type i = 0; i < m_; ++i) {
+                for (size_type k = 0; k < lhs.n_; ++k) {
+                    for (size_type j = 0; j < n_; ++j) {
+                        (*this)(i, j) += lhs(i, k) * rhs(k, j);
+                    }
+                }
+            }
+        }
+    }
+
+public:
+    LayoutMatrix(size_type rows, size_type cols):
+        m_(rows), n_(cols), layout_(rows, cols), buffer_(layout_.size()) {}
+
+    template<typename A>
+    explicit LayoutMatrix(const Matrix<value_type, A>& mtx):
+        LayoutMatrix(mtx.rows(), mtx.cols()) {
+        for (size_type i = 0; i < m_; ++i) {
+            for (size_type j = 0; j < n_; ++j) {
+                (*this)(i, j) = mtx[i][j];
+            }
+        }
+    }
+
+    template<typename L2>
+    explicit LayoutMatrix(const LayoutMatrix<value_type, L2>& rhs):
+        LayoutMatrix(rhs.rows(), rhs.cols()) {
+        assign(rhs);
+    }
+
+    size_type rows() const {
+        return m_;
+    }
+
+    size_type cols() const {
+        return n_;
+    }
+
+    const L& layout() const {
+        return layout_;
+    }
+
+    value_type* data() {
+        return buffer_.data();
+    }
+
+    const value_type* data() const {
+        return buffer_.data();
+    }
+
+    reference operator()(size_type i, size_type j) {
+        return buffer_[layout_.offset(i, j)];
+    }
+
+    const_reference operator()(size_type i, size_type j) const {
+        return buffer_[layout_.offset(i, j)];
+    }
+
+    MatrixView<value_type> tile(size_type bi, size_type bj) requires isMortonLayout<L> {
+        return MatrixView<value_type>{data() + layout_.tileOffset(bi, bj), L::tile, L::tile, L::tile};
+    }
+
+    ConstMatrixView<value_type> tile(size_type bi, size_type bj) const requires isMortonLayout<L> {
+        return ConstMatrixView<value_type>{data() + layout_.tileOffset(bi, bj), L::tile, L::tile, L::tile};
+    }
+
+    Matrix<value_type> toMatrix() const {
+        Matrix<value_type> res{m_, n_, uninitialized};
+        for (size_type i = 0; i < m_; ++i) {
+            for (size_type j = 0; j < n_; ++j) {
+                res[i][j] = (*this)(i, j);
+            }
+        }
+        return res;
+    }
+
+    template<typename L2>
+    LayoutMatrix& operator+=(const LayoutMatrix<value_type, L2>& rhs) {
+        if (m_ != rhs.m_ || n_ != rhs.n_) {
+            throw std::logic_error("Operator +=: sizes don't match");
+        }
+        if constexpr (std::is_same_v<L, L2>) {
+            for (size_type k = 0; k < buffer_.size(); ++k) {
+                buffer_[k] += rhs.buffer_[k];
+            }
+        } else {
+            for (size_type i = 0; i < m_; ++i) {
+                for (size_type j = 0; j < n_; ++j) {
+                    (*this)(i, j) += rhs(i, j);
+                }
+            }
+        }
+        return *this;
+    }
+
+    template<typename L2>
+    LayoutMatrix& operator-=(const LayoutMatrix<value_type, L2>& rhs) {
+        if (m_ != rhs.m_ || n_ != rhs.n_) {
+            throw std::logic_error("Operator -=: sizes don't match");
+        }
+        if constexpr (std::is_same_v<L, L2>) {
+            for (size_type k = 0; k < buffer_.size(); ++k) {
+                buffer_[k] -= rhs.buffer_[k];
+            }
+        } else {
+            for (size_type i = 0; i < m_; ++i) {
+                for (size_type j = 0; j < n_; ++j) {
+                    (*this)(i, j) -= rhs(i, j);
+                }
+            }
+        }
+        return *this;
+    }
+
+    LayoutMatrix& operator*=(const value_type& rhs) {
+        for (size_type k = 0; k < buffer_.size(); ++k) {
+            buffer_[k] *= rhs;
+        }
+        return *this;
+    }
+
+    template<typename L2>
+    LayoutMatrix& operator*=(const LayoutMatrix<value_type, L2>& rhs) {
+        if (n_ != rhs.m_) {
+            throw std::logic_error("Operator *=: sizes don't match");
+        }
+        LayoutMatrix product{m_, rhs.n_};
+        if constexpr (std::is_same_v<L, L2>) {
+            product.multiply(*this, rhs);
+        } else {
+            product.multiply(*this, LayoutMatrix<value_type, L>{rhs});
+        }
+        std::swap(*this, product);
+        return *this;
+    }
+
+    std::vector<size_type> factorizeLU() requires (isMortonLayout<L> && std::is_floating_point_v<value_type>) {
+        if (m_ != n_) {
+            throw std::logic_error("LU: matrix isn't square");
+        }
+        constexpr size_type ts = L::tile;
+        size_type nt = layout_.tileRows();
+        std::vector<size_type> pivots(n_);
+        auto row = [this] (size_type g, size_type bj) {
+            return &tile(g / ts, bj)(g % ts, 0);
+        };
+        for (size_type k = 0; k < nt; ++k) {
+            size_type w = std::min(ts, n_ - k * ts);
+            for (size_type c = 0; c < w; ++c) {
+                size_type g = k * ts + c;
+                size_type p = g;
+                for (size_type r = g + 1U; r < n_; ++r) {
+                    if (std::abs(row(r, k)[c]) > std::abs(row(p, k)[c])) {
+                        p = r;
+                    }
+                }
+                pivots[g] = p;
+                if (p != g) {
+                    for (size_type bj = 0; bj < nt; ++bj) {
+                        std::swap_ranges(row(g, bj), row(g, bj) + ts, row(p, bj));
+                    }
+                }
+                const value_type* rowG = row(g, k);
+                if (rowG[c] == value_type{0}) {
+                    continue;
+                }
+                const value_type inv = value_type{1} / rowG[c];
+                for (size_type r = g + 1U; r < n_; ++r) {
+                    value_type* rowR = row(r, k);
+                    value_type coef = rowR[c] * inv;
+                    rowR[c] = coef;
+                    for (size_type cc = c + 1U; cc < w; ++cc) {
+                        rowR[cc] -= coef * rowG[cc];
+                    }
+                }
+            }
+            if (k + 1U == nt) {
+                break;
+            }
+
+            //U_kj = L_kk^-1 A_kj, kept negated, so that gemm subtracts L_ik U_kj
+            size_type rest = nt - k - 1U;
+            std::vector<Matrix<value_type>> negU(rest);
+            auto lkk = tile(k, k);
+            ThreadPool::instance().parallelFor(0, rest, [&] (size_type first, size_type last) {
+                for (size_type t = first; t < last; ++t) {
+                    auto u = tile(k, k + 1U + t);
+                    for (size_type i = 1; i < w; ++i) {
+                        for (size_type p = 0; p < i; ++p) {
+                            const value_type coef = lkk(i, p);
+                            for (size_type j = 0; j < ts; ++j) {
+                                u(i, j) -= coef * u(p, j);
+                            }
+                        }
+                    }
+                    negU[t] = Matrix<value_type>{u};
+                    negU[t]*=value_type{-1};
+                }
+            });
+            ThreadPool::instance().parallelFor(0, rest * rest, [&] (size_type first, size_type last) {
+                for (size_type t = first; t < last; ++t) {
+                    size_type bi = k + 1U + t / rest;
+                    size_type bj = t % rest;
+                    gemm<value_type>(tile(bi, k), negU[bj].view(), tile(bi, k + 1U + bj));
+                }
+            });
+        }
+        return pivots;
+    }
+
+    value_type det() const requires (isMortonLayout<L> && std::is_floating_point_v<value_type>) {
+        LayoutMatrix lu{*this};
+        std::vector<size_type> pivots = lu.factorizeLU();
+        value_type res{1};
+        for (size_type g = 0; g < n_; ++g) {
+            res *= pivots[g] == g ? lu(g, g) : -lu(g, g);
+        }
+        return res;
+    }
+
+    template<typename L2>
+    bool operator==(const LayoutMatrix<value_type, L2>& rhs) const {
+        if (m_ != rhs.m_ || n_ != rhs.n_) {
+            return false;
+        }
+        for (size_type i = 0; i < m_; ++i) {
+            for (size_type j = 0; j < n_; ++j) {
+                if (!equals((*this)(i, j), rhs(i, j))) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    template<typename L2>
+    bool operator!=(const LayoutMatrix<value_type, L2>& rhs) const {
+        return !(*this == rhs);
+    }
+
+    LayoutMatrix& transpose() {
+        if constexpr (isMortonLayout<L>) {
+            if (m_ == n_) {
+                size_type nt = layout_.tileRows();
+                for (size_type bi = 0; bi < nt; ++bi) {
+                    for (size_type bj = bi; bj < nt; ++bj) {
+                        auto a = tile(bi, bj);
+                        auto b = tile(bj, bi);
+                        for (size_type i = 0; i < L::tile; ++i) {
+                            for (size_type j = bi == bj ? i + 1 : 0; j < L::tile; ++j) {
+                                std::swap(a(i, j), b(j, i));
+                            }
+                        }
+                    }
+                }
+                return *this;
+            }
+        } else if constexpr (std::is_same_v<L, RowMajorLayout> || std::is_same_v<L, ColMajorLayout>) {
+            if (m_ == n_) {
+                for (size_type i = 0; i < m_; ++i) {
+                    for (size_type j = i + 1; j < n_; ++j) {
+                        std::swap((*this)(i, j), (*this)(j, i));
+                    }
+                }
+                return *this;
+            }
+        }
+        LayoutMatrix res{n_, m_};
+        for (size_type i = 0; i < m_; ++i) {
+            for (size_type j = 0; j < n_; ++j) {
+                res(j, i) = (*this)(i, j);
+            }
+        }
+        std::swap(*this, res);
+        return *this;
+    }
+};
+
+template<typename T, typename L, typename L2>
+LayoutMatrix<T, L> operator+(const LayoutMatrix<T, L>& lhs, const LayoutMatrix<T, L2>& rhs) {
+    LayoutMatrix<T, L> res{lhs};
+    res+=rhs;
+    return res;
+}
+
+template<typename T, typename L, typename L2>
+LayoutMatrix<T, L> operator-(const LayoutMatrix<T, L>& lhs, const LayoutMatrix<T, L2>& rhs) {
+    LayoutMatrix<T, L> res{lhs};
+    res-=rhs;
+    return res;
+}
+
+template<typename T, typename L, typename L2>
+LayoutMatrix<T, L> operator*(const LayoutMatrix<T, L>& lhs, const LayoutMatrix<T, L2>& rhs) {
+    LayoutMatrix<T, L> res{lhs};
+    res*=rhs;
+    return res;
+}
+
+template<typename T, typename L>
+LayoutMatrix<T, L> operator*(const LayoutMatrix<T, L>& lhs, const T& rhs) {
+    LayoutMatrix<T, L> res{lhs};
+    res*=rhs;
+    return res;
+}
+
+} //namespace matrix
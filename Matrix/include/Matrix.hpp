@@ -4,27 +4,56 @@
 Class Iterator and ConstIterator. Class to iterate over Storage.
 
 Class Storage. Due to this class there is no need to write rule of five.
+Memory is taken from Alloc (64-byte aligned by default, see Allocator.hpp).
+Constructor with Uninitialized tag skips initialization of trivial elements.
 
 Class Matrix. Functionality:
+    Matrix(m, n, uninitialized) - matrix whose elements are going to be overwritten
     operator[]
     size_type rows()
     size_type cols()
     bool square()
     bool empty()
     bool equals(const Matrix&)
-    value_type det()
+    value_type det() - exact multi-modular for integral types, Gauss for floating point,
+        elimination with ModInt::subMul rows for ModInt, Bareiss for other types (Rational)
+    std::string detDecimal() - integral types: exact multi-modular determinant of any
+        size as a decimal string, for determinants that don't fit in value_type
+    value_type detBareiss(), detGauss() - explicit choice of the algorithm; Bareiss for
+        signed integers is parallel and throws std::overflow_error if an intermediate
+        minor doesn't fit in value_type
     void transpose()
     operator+=
     operator-=
-    operator*=
+    operator*= - blocked gemm, Strassen-Winograd for square n >= strassenThreshold on a
+        single thread (see useStrassen)
+    Matrix& assignProduct(lhs, rhs) - *this = lhs * rhs, views may alias *this
     operator/=
     void dump()
     void read()
+    MatrixView view(), block(i, j, m, n) - O(1) views, valid while the matrix lives
+        and isn't resized or multiplied. Arithmetic operators, det() and I/O also accept views.
+
+Free operators +, -, *, / take Matrix&& on either side and then reuse the expiring
+buffer, so (a + b) + c allocates once. Products go through a per-thread scratch buffer
+that is kept only while it is at most scratchMaxBytes.
+
+Function pow(mtx, k). Binary exponentiation, O(log k) products over three preallocated
+buffers (result, base, product) that swap roles instead of allocating.
+Function powApply(mtx, k, x). A^k x: k gemv calls when that's cheaper than pow, i.e.
+when k < n log k, otherwise pow(mtx, k) and one gemv.
 */
 
 #include <list>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <limits>
+#include <cassert>
 #include <memory>
+#include <cstdint>
 #include <fstream>
+#include <iomanip>
 #include <cstddef>
 #include <cstring>
 #include <iterator>
@@ -32,16 +61,25 @@ Class Matrix. Functionality:
 #include <algorithm>
 #include <stdexcept>
 #include "Utils.hpp"
+#include "Allocator.hpp"
+#include "MatrixView.hpp"
+#include "Modular.hpp"
+#include "ModInt.hpp"
+#include "Rational.hpp"
+#include "ThreadPool.hpp"
+#include "Strassen.hpp"
 
 namespace matrix {
 
+inline constexpr std::size_t scratchMaxBytes = 1U << 22U;
+
 template<typename T>
 class Iterator;
 template<typename T>
 class ConstIterator;
-template<typename T>
+template<typename T, typename Alloc = AlignedAllocator<T>>
 class Storage;
-template<typename T>
+template<typename T, typename Alloc = AlignedAllocator<T>>
 class Matrix;
 
 template<typename T>
@@ -178,7 +216,7 @@ public:
     }
 };
 
-template<typename T>
+template<typename T, typename Alloc>
 class Storage final
 {
     using value_type = T;
@@ -189,8 +227,10 @@ class Storage final
     using const_pointer = const T *;
     using reference = T &;
     using const_reference = const T &;
+    using alloc_traits = std::allocator_traits<Alloc>;
 
-    std::unique_ptr<value_type[]> data_;
+    Alloc alloc_;
+    pointer data_ = nullptr;
     size_type size_ = 0U;
 
     bool equals(const Storage& rhs) const {
@@ -205,32 +245,75 @@ class Storage final
         return true;
     }
 
+    void allocate(size_type size) {
+        data_ = size ? alloc_traits::allocate(alloc_, size) : nullptr;
+        size_ = size;
+    }
+
+    void deallocate() noexcept {
+        if (!data_) {
+            return;
+        }
+        std::destroy_n(data_, size_);
+        alloc_traits::deallocate(alloc_, data_, size_);
+        data_ = nullptr;
+        size_ = 0U;
+    }
+
+    template<typename F>
+    void construct(size_type size, F func) {
+        allocate(size);
+        try {
+            func(data_);
+        } catch (...) {
+            alloc_traits::deallocate(alloc_, data_, size_);
+            data_ = nullptr;
+            size_ = 0U;
+            throw;
+        }
+    }
+
+    void swap(Storage& rhs) noexcept {
+        std::swap(alloc_, rhs.alloc_);
+        std::swap(data_, rhs.data_);
+        std::swap(size_, rhs.size_);
+    }
+
 public:
     Storage() {}
 
     Storage(size_type size) {
-        data_ = std::make_unique<value_type[]>(size);
-        size_ = size;
+        construct(size, [size] (pointer data) {
+            std::uninitialized_value_construct_n(data, size);
+        });
     }
 
-    Storage(size_type size, const_reference val):
-        Storage(size) {
-        std::fill_n(data_.get(), size, val);
+    Storage(size_type size, Uninitialized) {
+        construct(size, [size] (pointer data) {
+            std::uninitialized_default_construct_n(data, size);
+        });
+    }
+
+    Storage(size_type size, const_reference val) {
+        construct(size, [size, &val] (pointer data) {
+            std::uninitialized_fill_n(data, size, val);
+        });
     }
 
     Storage(size_type size, std::initializer_list<value_type> lst):
         Storage(size) {
-        std::copy_n(lst.begin(), std::min(size, lst.size()), data_.get());
+        std::copy_n(lst.begin(), std::min(size, lst.size()), data_);
     }
 
-    Storage(const Storage<T>& rhs):
-        Storage(rhs.size_) {
-        std::copy_n(rhs.data_.get(), rhs.size_, data_.get());
+    Storage(const Storage& rhs):
+        alloc_(alloc_traits::select_on_container_copy_construction(rhs.alloc_)) {
+        construct(rhs.size_, [&rhs] (pointer data) {
+            std::uninitialized_copy_n(rhs.data_, rhs.size_, data);
+        });
     }
 
-    Storage(Storage<T>&& rhs) noexcept {
-        std::swap(data_, rhs.data_);
-        std::swap(size_, rhs.size_);
+    Storage(Storage&& rhs) noexcept {
+        swap(rhs);
     }
 
     Storage& operator=(const Storage& rhs) {
@@ -238,8 +321,7 @@ public:
             return *this;
         }
         Storage temp{rhs};
-        std::swap(data_, temp.data_);
-        std::swap(size_, temp.size_);
+        swap(temp);
         return *this;
     }
 
@@ -248,12 +330,13 @@ public:
             return *this;
         }
         Storage temp{std::move(rhs)};
-        std::swap(data_, temp.data_);
-        std::swap(size_, temp.size_);
+        swap(temp);
         return *this;
     }
 
-    ~Storage() = default;
+    ~Storage() {
+        deallocate();
+    }
 
     size_type size() const {
         return size_;
@@ -292,31 +375,37 @@ public:
     }
 
     iterator begin() {
-        return iterator{data_.get()};
+        return iterator{data_};
     }
 
     iterator end() {
-        return iterator{data_.get() + size_};
+        return iterator{data_ + size_};
     }
 
     const_iterator begin() const {
-        return const_iterator{data_.get()};
+        return const_iterator{data_};
     }
 
     const_iterator end() const {
-        return const_iterator{data_.get() + size_};
+        return const_iterator{data_ + size_};
+    }
+
+    pointer data() {
+        return data_;
+    }
+
+    const_pointer data() const {
+        return data_;
     }
 
     void resize(size_type size) {
         Storage temp{size};
-        std::move(data_.get(), data_.get() + std::min(size_, size), temp.data_.get());
-        std::swap(temp.data_, data_);
-        std::swap(temp.size_, size_);
+        std::move(data_, data_ + std::min(size_, size), temp.data_);
+        swap(temp);
     }
 
     void clear() {
-        size_ = 0U;
-        data_.reset();
+        deallocate();
     }
 
     void dump() const {
@@ -331,7 +420,7 @@ public:
     }
 };
 
-template<typename T>
+template<typename T, typename Alloc>
 class Matrix final
 {
     using value_type = T;
@@ -343,9 +432,11 @@ class Matrix final
     using reference = T &;
     using const_reference = const T &;
 
-    size_type m_;
-    size_type n_;
-    Storage<value_type> buffer_;
+    static constexpr size_type transposeBlock = 16U;
+
+    size_type m_ = 0U;
+    size_type n_ = 0U;
+    Storage<value_type, Alloc> buffer_;
     Storage<size_type> rows_;
 
     class ProxyRow
@@ -378,6 +469,14 @@ class Matrix final
             return n_;
         }
 
+        pointer data() {
+            return row_;
+        }
+
+        const_pointer data() const {
+            return row_;
+        }
+
         iterator begin() {
             return iterator{row_};
         }
@@ -417,6 +516,10 @@ class Matrix final
             return n_;
         }
 
+        const_pointer data() const {
+            return row_;
+        }
+
         const_iterator begin() const {
             return const_iterator{row_};
         }
@@ -436,11 +539,46 @@ class Matrix final
         std::swap(rows_[i], rows_[j]);
     }
 
+    pointer rowData(size_type i) {
+        return buffer_.data() + rows_.data()[i];
+    }
+
+    const_pointer rowData(size_type i) const {
+        return buffer_.data() + rows_.data()[i];
+    }
+
+    //Cache-oblivious out-of-place transpose: halve the longer side until the tile
+    //fits transposeBlock x transposeBlock, so both source and destination tiles stay in L1.
+    void transposeTo(Matrix& dst, size_type i0, size_type i1, size_type j0, size_type j1) {
+        if (i1 - i0 <= transposeBlock && j1 - j0 <= transposeBlock) {
+            for (size_type i = i0; i < i1; ++i) {
+                pointer src = rowData(i);
+                for (size_type j = j0; j < j1; ++j) {
+                    dst.rowData(j)[i] = std::move(src[j]);
+                }
+            }
+        } else if (i1 - i0 >= j1 - j0) {
+            size_type mid = i0 + (i1 - i0) / 2;
+            transposeTo(dst, i0, mid, j0, j1);
+            transposeTo(dst, mid, i1, j0, j1);
+        } else {
+            size_type mid = j0 + (j1 - j0) / 2;
+            transposeTo(dst, i0, i1, j0, mid);
+            transposeTo(dst, i0, i1, mid, j1);
+        }
+    }
+
+    //In-place blocked transpose: tile (bi, bj) is swapped with transposed tile (bj, bi).
     Matrix& transposeSquare() {
-        if (m_ != 1U) {
-            for (size_type i = 0; i < m_; ++i) {
-                for (size_type j = i + 1; j < n_; ++j) {
-                    std::swap((*this)[i][j], (*this)[j][i]);
+        for (size_type bi = 0; bi < n_; bi += transposeBlock) {
+            size_type iEnd = std::min(bi + transposeBlock, n_);
+            for (size_type bj = bi; bj < n_; bj += transposeBlock) {
+                size_type jEnd = std::min(bj + transposeBlock, n_);
+                for (size_type i = bi; i < iEnd; ++i) {
+                    pointer row = rowData(i);
+                    for (size_type j = (bi == bj ? i + 1 : bj); j < jEnd; ++j) {
+                        std::swap(row[j], rowData(j)[i]);
+                    }
                 }
             }
         }
@@ -474,6 +612,66 @@ class Matrix final
         return k;
     }
 
+    value_type detModular() const requires std::is_integral_v<value_type> {
+        if (!square()) {
+            throw std::logic_error("Matrix isn't square");
+        }
+        if (empty()) {
+            throw std::logic_error("Matrix is empty");
+        }
+        return detMultiModular<value_type>(n_, [this] (size_type i) { return rowData(i); });
+    }
+
+    //Gaussian elimination over Z/PZ. Every row update is one ModInt::subMul, rows of the
+    //trailing submatrix are spread over the ThreadPool.
+    value_type detElimination() const requires isModInt<value_type> {
+        if (!square()) {
+            throw std::logic_error("Matrix isn't square");
+        }
+        if (empty()) {
+            throw std::logic_error("Matrix is empty");
+        }
+        Matrix mtx{*this};
+        value_type det{1};
+        for (size_type k = 0; k < n_; ++k) {
+            size_type m = mtx.nonZeroRowInCol(k);
+            if (m == n_) {
+                return value_type{0};
+            } else if (m != k) {
+                mtx.swapRows(m, k);
+                det = -det;
+            }
+            det*=mtx[k][k];
+            const value_type inv = mtx[k][k].inv();
+            const value_type* rowK = mtx.rowData(k);
+            size_type minRows = std::max<size_type>(1U, 4096U / (n_ - k));
+            ThreadPool::instance().parallelFor(k + 1, n_, [&] (size_type first, size_type last) {
+                for (size_type i = first; i < last; ++i) {
+                    value_type* rowI = mtx.rowData(i);
+                    if (isZero(rowI[k])) {
+                        continue;
+                    }
+                    value_type::subMul(rowI + k + 1, rowK + k + 1, rowI[k] * inv, n_ - k - 1);
+                }
+            }, minRows);
+        }
+        return det;
+    }
+
+    //Products are computed into a per-thread scratch matrix, which then swaps buffers with
+    //the result: repeated products of one shape alternate between the same two buffers
+    //instead of allocating. The scratch keeps the memory of the last product shape only up to
+    //scratchMaxBytes, a bigger buffer is released after the product, so one large product
+    //doesn't pin its memory in every thread that ever computed one.
+    static Matrix& scratch(size_type m, size_type n) {
+        thread_local Matrix buffer;
+        if (buffer.m_ != m || buffer.n_ != n) {
+            buffer = Matrix{m, n, uninitialized};
+        }
+        return buffer;
+    }
+
+public:
     value_type detBareiss() const {
         if (!square()) {
             throw std::logic_error("Matrix isn't square");
@@ -507,6 +705,62 @@ class Matrix final
         return sign * mtx[n_ - 1][n_ - 1];
     }
 
+    //Bareiss for signed integers: every entry of step k is (a_kk a_ij - a_ik a_kj) / a_prev,
+    //computed in a type twice as wide, so the products are exact, and checked against the
+    //range of value_type, and so is the signed result. Rows of the trailing submatrix are
+    //spread over the ThreadPool; the wide division by a_prev keeps the inner loop scalar.
+    //Pivot rows are swapped by rows_.
+    value_type detBareiss() const requires (std::is_integral_v<value_type> && std::is_signed_v<value_type>) {
+        using Wide = std::conditional_t<sizeof(value_type) <= 4U, std::int64_t, i128>;
+        if (!square()) {
+            throw std::logic_error("Matrix isn't square");
+        }
+        if (empty()) {
+            throw std::logic_error("Matrix is empty");
+        }
+        if (n_ == 1U) {
+            return (*this)[0][0];
+        }
+        constexpr Wide lowest = std::numeric_limits<value_type>::min();
+        constexpr Wide highest = std::numeric_limits<value_type>::max();
+        Matrix mtx{*this};
+        Wide sign = 1;
+        Wide prev = 1;
+        for (size_type k = 0; k < n_ - 1; ++k) {
+            size_type m = mtx.nonZeroRowInCol(k);
+            if (m == n_) {
+                return value_type{0};
+            } else if (m != k) {
+                mtx.swapRows(m, k);
+                sign = -sign;
+            }
+            const_pointer rowK = mtx.rowData(k);
+            const Wide pivot = rowK[k];
+            size_type minRows = std::max<size_type>(1U, (1U << 12U) / (n_ - k));
+            ThreadPool::instance().parallelFor(k + 1, n_, [&] (size_type first, size_type last) {
+                for (size_type i = first; i < last; ++i) {
+                    pointer rowI = mtx.rowData(i);
+                    const Wide lead = rowI[k];
+                    bool overflow = false;
+                    for (size_type j = k + 1; j < n_; ++j) {
+                        Wide value = (pivot * rowI[j] - lead * rowK[j]) / prev;
+                        overflow |= value < lowest || value > highest;
+                        rowI[j] = static_cast<value_type>(value);
+                    }
+                    if (overflow) {
+                        throw std::overflow_error("Det: Bareiss intermediate doesn't fit in value type");
+                    }
+                }
+            }, minRows);
+            prev = pivot;
+        }
+        Wide res = sign * mtx[n_ - 1][n_ - 1];
+        if (res < lowest || res > highest) {
+            throw std::overflow_error("Det: Bareiss result doesn't fit in value type");
+        }
+        return static_cast<value_type>(res);
+    }
+
     value_type detGauss() const requires std::is_floating_point_v<value_type> {
         if (!square()) {
             throw std::logic_error("Matrix isn't square");
@@ -542,7 +796,6 @@ class Matrix final
         return sign * detAbs;
     }
 
-public:
     Matrix() = default;
 
     Matrix(size_type size):
@@ -553,6 +806,11 @@ public:
         setRows();
     }
 
+    Matrix(size_type m, size_type n, Uninitialized):
+        m_(m), n_(n), buffer_(m * n, uninitialized), rows_(m) {
+        setRows();
+    }
+
     Matrix(std::initializer_list<std::initializer_list<value_type>> lst):
         m_(lst.size()), n_(::matrix::maxNestedLstSize(lst)), buffer_(m_ * n_), rows_(m_) {
         size_type i = 0U;
@@ -566,6 +824,13 @@ public:
         setRows();
     }
 
+    template<typename U>
+    requires std::is_same_v<std::remove_const_t<U>, value_type>
+    explicit Matrix(MatrixView<U> view):
+        Matrix(view.rows(), view.cols(), uninitialized) {
+        this->view().assign(view);
+    }
+
     static Matrix eye(size_type size, const value_type& val) {
         Matrix res{size};
         for (size_type i = 0; i < size; ++i) {
@@ -578,14 +843,31 @@ public:
         Matrix res{size};
         size_type i = 0;
         for (const auto& elem: lst) {
-            if (i == lst.size()) {
+            if (i == size) {
                 break;
             }
-            res[i][i++] = elem;
+            res[i][i] = elem;
+            ++i;
         }
         return res;
     }
 
+    MatrixView<value_type> view() {
+        return MatrixView<value_type>{buffer_.data(), m_, n_, n_};
+    }
+
+    ConstMatrixView<value_type> view() const {
+        return ConstMatrixView<value_type>{buffer_.data(), m_, n_, n_};
+    }
+
+    MatrixView<value_type> block(size_type i, size_type j, size_type m, size_type n) {
+        return view().block(i, j, m, n);
+    }
+
+    ConstMatrixView<value_type> block(size_type i, size_type j, size_type m, size_type n) const {
+        return view().block(i, j, m, n);
+    }
+
     ProxyRow operator[](size_type indx) {
         return ProxyRow{std::addressof(buffer_[0]) + rows_[indx], n_};
     }
@@ -622,20 +904,34 @@ public:
         return detBareiss();
     }
 
+    value_type det() const requires std::is_integral_v<value_type> {
+        return detModular();
+    }
+
     value_type det() const requires std::is_floating_point_v<value_type> {
         return detGauss();
     }
 
+    std::string detDecimal() const requires std::is_integral_v<value_type> {
+        if (!square()) {
+            throw std::logic_error("Matrix isn't square");
+        }
+        if (empty()) {
+            throw std::logic_error("Matrix is empty");
+        }
+        return detMultiModularDecimal<value_type>(n_, [this] (size_type i) { return rowData(i); });
+    }
+
+    value_type det() const requires isModInt<value_type> {
+        return detElimination();
+    }
+
     Matrix& transpose() {
         if (square()) {
             return transposeSquare();
         }
-        Matrix transposed{n_, m_};
-        for (size_type i = 0; i < m_; ++i) {
-            for (size_type j = 0; j < n_; ++j) {
-                transposed[j][i] = std::move((*this)[i][j]);
-            }
-        }
+        Matrix transposed{n_, m_, uninitialized};
+        transposeTo(transposed, 0, m_, 0, n_);
         *this = std::move(transposed);
         return *this;
     }
@@ -665,18 +961,44 @@ public:
     }
 
     Matrix& operator*=(const Matrix& rhs) {
-        if (n_ != rhs.m_) {
+        return *this *= rhs.view();
+    }
+
+    Matrix& operator+=(ConstMatrixView<value_type> rhs) {
+        if (m_ != rhs.rows() || n_ != rhs.cols()) {
+            throw std::logic_error("Operator +=: sizes don't match");
+        }
+        view() += rhs;
+        return *this;
+    }
+
+    Matrix& operator-=(ConstMatrixView<value_type> rhs) {
+        if (m_ != rhs.rows() || n_ != rhs.cols()) {
+            throw std::logic_error("Operator -=: sizes don't match");
+        }
+        view() -= rhs;
+        return *this;
+    }
+
+    Matrix& operator*=(ConstMatrixView<value_type> rhs) {
+        return assignProduct(view(), rhs);
+    }
+
+    Matrix& assignProduct(ConstMatrixView<value_type> lhs, ConstMatrixView<value_type> rhs) {
+        if (lhs.cols() != rhs.rows()) {
             throw std::logic_error("Operator *=: sizes don't match");
         }
-        Matrix product{m_, rhs.n_};
-        for (size_type i = 0; i < m_; ++i) {
-            for (size_type j = 0; j < rhs.n_; ++j) {
-                for (size_type k = 0; k < n_; ++k) {
-                    product[i][j] += (*this)[i][k] * rhs[k][j];
-                }
-            }
+        Matrix& product = scratch(lhs.rows(), rhs.cols());
+        if (useStrassen(lhs, rhs)) {
+            strassen<value_type>(lhs, rhs, product.view());
+        } else {
+            product.view().fill(value_type{});
+            gemm<value_type>(lhs, rhs, product.view());
         }
         std::swap(*this, product);
+        if (product.m_ * product.n_ * sizeof(value_type) > scratchMaxBytes) {
+            product = Matrix{};
+        }
         return *this;
     }
 
@@ -718,67 +1040,293 @@ public:
 
     void read(std::istream& is) {
         for (size_type i = 0; i < m_; ++i) {
+            pointer row = rowData(i);
             for (size_type j = 0; j < n_; ++j) {
-                is >> (*this)[i][j];
+                if constexpr (std::is_arithmetic_v<value_type>) {
+                    if (!::matrix::readValue(*is.rdbuf(), row[j])) {
+                        is.setstate(std::ios::failbit);
+                        return;
+                    }
+                } else {
+                    is >> row[j];
+                }
             }
         }
     }
 };
 
-template<typename T>
-std::ostream& operator<<(std::ostream& os, const Matrix<T>& mtx)
+template<typename T, typename A>
+std::ostream& operator<<(std::ostream& os, const Matrix<T, A>& mtx)
 {
     mtx.dump(os);
     return os;
 }
 
-template<typename T>
-std::istream& operator>>(std::istream& is, Matrix<T>& mtx)
+template<typename T, typename A>
+std::istream& operator>>(std::istream& is, Matrix<T, A>& mtx)
 {
     mtx.read(is);
     return is;
 }
 
-template<typename T>
-Matrix<T> operator+(const Matrix<T>& lhs, const Matrix<T>& rhs) {
-    Matrix<T> res{lhs};
+template<typename T, typename A>
+Matrix<T, A> operator+(const Matrix<T, A>& lhs, const Matrix<T, A>& rhs) {
+    Matrix<T, A> res{lhs};
     res+=rhs;
     return res;
 }
 
-template<typename T>
-Matrix<T> operator-(const Matrix<T>& lhs, const Matrix<T>& rhs) {
-    Matrix<T> res{lhs};
+template<typename T, typename A>
+Matrix<T, A> operator-(const Matrix<T, A>& lhs, const Matrix<T, A>& rhs) {
+    Matrix<T, A> res{lhs};
     res-=rhs;
     return res;
 }
 
-template<typename T>
-Matrix<T> operator*(const Matrix<T>& lhs, const T& rhs) {
-    Matrix<T> res{lhs};
+template<typename T, typename A>
+Matrix<T, A> operator*(const Matrix<T, A>& lhs, const T& rhs) {
+    Matrix<T, A> res{lhs};
     res*=rhs;
     return res;
 }
 
-template<typename T>
-Matrix<T> operator*(const T& lhs, const Matrix<T>& rhs) {
-    Matrix<T> res{rhs};
+template<typename T, typename A>
+Matrix<T, A> operator*(const T& lhs, const Matrix<T, A>& rhs) {
+    Matrix<T, A> res{rhs};
     res*=lhs;
     return res;
 }
 
+template<typename T, typename A>
+Matrix<T, A> operator*(const Matrix<T, A>& lhs, const Matrix<T, A>& rhs) {
+    Matrix<T, A> res;
+    res.assignProduct(lhs.view(), rhs.view());
+    return res;
+}
+
+template<typename T, typename A>
+Matrix<T, A> operator/(const Matrix<T, A>& lhs, const T& rhs) {
+    Matrix<T, A> res{lhs};
+    res/=rhs;
+    return res;
+}
+
+template<typename T, typename A>
+Matrix<T, A> operator+(Matrix<T, A>&& lhs, const Matrix<T, A>& rhs) {
+    lhs+=rhs;
+    return std::move(lhs);
+}
+
+template<typename T, typename A>
+Matrix<T, A> operator+(const Matrix<T, A>& lhs, Matrix<T, A>&& rhs) {
+    rhs+=lhs;
+    return std::move(rhs);
+}
+
+template<typename T, typename A>
+Matrix<T, A> operator+(Matrix<T, A>&& lhs, Matrix<T, A>&& rhs) {
+    lhs+=rhs;
+    return std::move(lhs);
+}
+
+template<typename T, typename A>
+Matrix<T, A> operator-(Matrix<T, A>&& lhs, const Matrix<T, A>& rhs) {
+    lhs-=rhs;
+    return std::move(lhs);
+}
+
+template<typename T, typename A>
+Matrix<T, A> operator-(const Matrix<T, A>& lhs, Matrix<T, A>&& rhs) {
+    if (lhs.rows() != rhs.rows() || lhs.cols() != rhs.cols()) {
+        throw std::logic_error("Operator -=: sizes don't match");
+    }
+    for (std::size_t i = 0; i < rhs.rows(); ++i) {
+        T* dst = rhs[i].data();
+        const T* src = lhs[i].data();
+        for (std::size_t j = 0; j < rhs.cols(); ++j) {
+            dst[j] = src[j] - dst[j];
+        }
+    }
+    return std::move(rhs);
+}
+
+template<typename T, typename A>
+Matrix<T, A> operator-(Matrix<T, A>&& lhs, Matrix<T, A>&& rhs) {
+    lhs-=rhs;
+    return std::move(lhs);
+}
+
+template<typename T, typename A>
+Matrix<T, A> operator*(Matrix<T, A>&& lhs, const T& rhs) {
+    lhs*=rhs;
+    return std::move(lhs);
+}
+
+template<typename T, typename A>
+Matrix<T, A> operator*(const T& lhs, Matrix<T, A>&& rhs) {
+    rhs*=lhs;
+    return std::move(rhs);
+}
+
+template<typename T, typename A>
+Matrix<T, A> operator*(Matrix<T, A>&& lhs, const Matrix<T, A>& rhs) {
+    lhs*=rhs;
+    return std::move(lhs);
+}
+
+template<typename T, typename A>
+Matrix<T, A> operator*(const Matrix<T, A>& lhs, Matrix<T, A>&& rhs) {
+    rhs.assignProduct(lhs.view(), rhs.view());
+    return std::move(rhs);
+}
+
+template<typename T, typename A>
+Matrix<T, A> operator*(Matrix<T, A>&& lhs, Matrix<T, A>&& rhs) {
+    lhs*=rhs;
+    return std::move(lhs);
+}
+
+template<typename T, typename A>
+Matrix<T, A> operator/(Matrix<T, A>&& lhs, const T& rhs) {
+    lhs/=rhs;
+    return std::move(lhs);
+}
+
+template<typename T>
+std::ostream& operator<<(std::ostream& os, MatrixView<T> view)
+{
+    os << "M " << view.rows() << "; N " << view.cols() << "\n";
+    for (std::size_t i = 0; i < view.rows(); ++i) {
+        for (std::size_t j = 0; j < view.cols(); ++j) {
+            os << std::setw(4) << view(i, j) << " ";
+        }
+        os << "\n";
+    }
+    os.flush();
+    return os;
+}
+
+template<typename T>
+std::istream& operator>>(std::istream& is, MatrixView<T> view) requires (!std::is_const_v<T>)
+{
+    for (std::size_t i = 0; i < view.rows(); ++i) {
+        for (std::size_t j = 0; j < view.cols(); ++j) {
+            if constexpr (std::is_arithmetic_v<T>) {
+                if (!::matrix::readValue(*is.rdbuf(), view(i, j))) {
+                    is.setstate(std::ios::failbit);
+                    return is;
+                }
+            } else {
+                is >> view(i, j);
+            }
+        }
+    }
+    return is;
+}
+
+template<typename T>
+std::remove_const_t<T> det(MatrixView<T> view) {
+    return Matrix<std::remove_const_t<T>>{view}.det();
+}
+
+template<typename T, typename U>
+Matrix<std::remove_const_t<T>> operator+(MatrixView<T> lhs, MatrixView<U> rhs) {
+    Matrix<std::remove_const_t<T>> res{lhs};
+    res+=rhs;
+    return res;
+}
+
+template<typename T, typename U>
+Matrix<std::remove_const_t<T>> operator-(MatrixView<T> lhs, MatrixView<U> rhs) {
+    Matrix<std::remove_const_t<T>> res{lhs};
+    res-=rhs;
+    return res;
+}
+
+template<typename T, typename U>
+Matrix<std::remove_const_t<T>> operator*(MatrixView<T> lhs, MatrixView<U> rhs) {
+    Matrix<std::remove_const_t<T>> res{lhs};
+    res*=rhs;
+    return res;
+}
+
 template<typename T>
-Matrix<T> operator*(const Matrix<T>& lhs, const Matrix<T>& rhs) {
-    Matrix<T> res{lhs};
+Matrix<std::remove_const_t<T>> operator*(MatrixView<T> lhs, const std::remove_const_t<T>& rhs) {
+    Matrix<std::remove_const_t<T>> res{lhs};
     res*=rhs;
     return res;
 }
 
 template<typename T>
-Matrix<T> operator/(const Matrix<T>& lhs, const T& rhs) {
-    Matrix<T> res{lhs};
+Matrix<std::remove_const_t<T>> operator*(const std::remove_const_t<T>& lhs, MatrixView<T> rhs) {
+    Matrix<std::remove_const_t<T>> res{rhs};
+    res*=lhs;
+    return res;
+}
+
+template<typename T>
+Matrix<std::remove_const_t<T>> operator/(MatrixView<T> lhs, const std::remove_const_t<T>& rhs) {
+    Matrix<std::remove_const_t<T>> res{lhs};
     res/=rhs;
     return res;
 }
 
+template<typename T, typename A>
+Matrix<T, A> pow(const Matrix<T, A>& mtx, std::uint64_t k) {
+    if (!mtx.square()) {
+        throw std::logic_error("Pow: matrix isn't square");
+    }
+    std::size_t n = mtx.rows();
+    if (k == 0U) {
+        return Matrix<T, A>::eye(n, T{1});
+    }
+    Matrix<T, A> base{mtx};
+    Matrix<T, A> res{n, n, uninitialized};
+    Matrix<T, A> product{n, n, uninitialized};
+    auto multiply = [&product] (const Matrix<T, A>& lhs, const Matrix<T, A>& rhs) {
+        if (useStrassen(lhs.view(), rhs.view())) {
+            strassen<T>(lhs.view(), rhs.view(), product.view());
+        } else {
+            product.view().fill(T{});
+            gemm<T>(lhs.view(), rhs.view(), product.view());
+        }
+    };
+    bool first = true;
+    while (true) {
+        if (k & 1U) {
+            if (first) {
+                res.view().assign(base.view());
+                first = false;
+            } else {
+                multiply(res, base);
+                std::swap(res, product);
+            }
+        }
+        k >>= 1U;
+        if (k == 0U) {
+            return res;
+        }
+        multiply(base, base);
+        std::swap(base, product);
+    }
+}
+
+template<typename T, typename A>
+std::vector<T> powApply(const Matrix<T, A>& mtx, std::uint64_t k, std::vector<T> x) {
+    if (!mtx.square() || mtx.cols() != x.size()) {
+        throw std::logic_error("PowApply: sizes don't match");
+    }
+    std::vector<T> y(x.size());
+    if (static_cast<double>(k) > static_cast<double>(mtx.rows()) * std::log2(static_cast<double>(k))) {
+        gemv<T>(pow(mtx, k).view(), x, y);
+        return y;
+    }
+    for (std::uint64_t step = 0; step < k; ++step) {
+        std::fill(y.begin(), y.end(), T{});
+        gemv<T>(mtx.view(), x, y);
+        std::swap(x, y);
+    }
+    return x;
+}
+
 } //namespace matrix
@@ -0,0 +1,205 @@
+#pragma once
+
+/*
+Class MatrixBatch. Many square matrices of one size n in a contiguous lane-interleaved
+layout: matrices are split into groups of batchLanes, and inside a group element (i, j)
+of all matrices is contiguous, i.e. [group][i][j][lane]. Functionality:
+    MatrixBatch(count, n)
+    MatrixBatch(span<const Matrix>)
+    size_type size()           - number of matrices
+    size_type dim()            - n
+    operator()(k, i, j)        - element (i, j) of matrix k
+    void set(k, view), Matrix get(k)
+    std::vector<value_type> det()
+
+For floating point det() runs Gaussian elimination with partial pivoting over a whole
+group at once: lane l eliminates matrix l with its own pivots, so every inner loop runs
+over the lanes and vectorizes. Singular lanes get a zero pivot and keep going with a
+zero multiplier, so the lanes never diverge. Groups are distributed over the ThreadPool.
+For integral types each matrix goes through Matrix::det(), also in parallel.
+
+Function detBatch(span<const Matrix>). Packs matrices into MatrixBatch and returns det().
+*/
+
+#include <span>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "Matrix.hpp"
+#include "FixedMatrix.hpp"
+#include "ThreadPool.hpp"
+
+namespace matrix {
+
+template<typename T>
+class MatrixBatch final
+{
+    using value_type = T;
+    using size_type = std::size_t;
+    using pointer = T *;
+    using const_pointer = const T *;
+    using reference = T &;
+    using const_reference = const T &;
+
+    static constexpr size_type lanes = batchLanes;
+
+    size_type count_ = 0U;
+    size_type n_ = 0U;
+    Storage<value_type> buffer_;
+
+    size_type groups() const {
+        return (count_ + lanes - 1U) / lanes;
+    }
+
+    size_type groupSize() const {
+        return n_ * n_ * lanes;
+    }
+
+    size_type index(size_type k, size_type i, size_type j) const {
+        return (k / lanes) * groupSize() + (i * n_ + j) * lanes + k % lanes;
+    }
+
+    //a is one group, [i][j][lane]; dets receives lanes values
+    void detGroup(pointer a, pointer dets) const {
+        alignas(cacheLineSize) value_type best[lanes];
+        alignas(cacheLineSize) value_type inv[lanes];
+        alignas(cacheLineSize) value_type coef[lanes];
+        size_type pivot[lanes];
+        std::fill_n(dets, lanes, value_type{1});
+        auto at = [a, this] (size_type i, size_type j) {
+            return a + (i * n_ + j) * lanes;
+        };
+        for (size_type k = 0; k < n_; ++k) {
+            std::fill_n(pivot, lanes, k);
+            for (size_type l = 0; l < lanes; ++l) {
+                best[l] = std::abs(at(k, k)[l]);
+            }
+            for (size_type i = k + 1; i < n_; ++i) {
+                const_pointer col = at(i, k);
+                for (size_type l = 0; l < lanes; ++l) {
+                    value_type value = std::abs(col[l]);
+                    pivot[l] = value > best[l] ? i : pivot[l];
+                    best[l] = value > best[l] ? value : best[l];
+                }
+            }
+            for (size_type l = 0; l < lanes; ++l) {
+                if (pivot[l] != k) {
+                    for (size_type j = k; j < n_; ++j) {
+                        std::swap(at(k, j)[l], at(pivot[l], j)[l]);
+                    }
+                    dets[l] = -dets[l];
+                }
+            }
+            const_pointer diag = at(k, k);
+            for (size_type l = 0; l < lanes; ++l) {
+                dets[l] *= diag[l];
+                inv[l] = diag[l] == value_type{0} ? value_type{0} : value_type{1} / diag[l];
+            }
+            for (size_type i = k + 1; i < n_; ++i) {
+                const_pointer lead = at(i, k);
+                for (size_type l = 0; l < lanes; ++l) {
+                    coef[l] = lead[l] * inv[l];
+                }
+                for (size_type j = k + 1; j < n_; ++j) {
+                    pointer dst = at(i, j);
+                    const_pointer src = at(k, j);
+                    for (size_type l = 0; l < lanes; ++l) {
+                        dst[l] -= coef[l] * src[l];
+                    }
+                }
+            }
+        }
+    }
+
+public:
+    MatrixBatch() = default;
+
+    MatrixBatch(size_type count, size_type n):
+        count_(count), n_(n), buffer_((count + lanes - 1U) / lanes * n * n * lanes) {}
+
+    explicit MatrixBatch(std::span<const Matrix<value_type>> mtxs):
+        count_(mtxs.size()), n_(mtxs.empty() ? 0U : mtxs.front().rows()),
+        buffer_(groups() * groupSize()) {
+        for (size_type k = 0; k < count_; ++k) {
+            set(k, mtxs[k].view());
+        }
+    }
+
+    size_type size() const {
+        return count_;
+    }
+
+    size_type dim() const {
+        return n_;
+    }
+
+    reference operator()(size_type k, size_type i, size_type j) {
+        return buffer_[index(k, i, j)];
+    }
+
+    const_reference operator()(size_type k, size_type i, size_type j) const {
+        return buffer_[index(k, i, j)];
+    }
+
+    void set(size_type k, ConstMatrixView<value_type> mtx) {
+        if (k >= count_) {
+            throw std::out_of_range("Set: index >= size");
+        }
+        if (mtx.rows() != n_ || mtx.cols() != n_) {
+            throw std::logic_error("Set: sizes don't match");
+        }
+        for (size_type i = 0; i < n_; ++i) {
+            for (size_type j = 0; j < n_; ++j) {
+                (*this)(k, i, j) = mtx(i, j);
+            }
+        }
+    }
+
+    Matrix<value_type> get(size_type k) const {
+        if (k >= count_) {
+            throw std::out_of_range("Get: index >= size");
+        }
+        Matrix<value_type> res{n_, n_, uninitialized};
+        for (size_type i = 0; i < n_; ++i) {
+            for (size_type j = 0; j < n_; ++j) {
+                res[i][j] = (*this)(k, i, j);
+            }
+        }
+        return res;
+    }
+
+    std::vector<value_type> det() const {
+        std::vector<value_type> dets(count_);
+        if constexpr (std::is_floating_point_v<value_type>) {
+            ThreadPool::instance().parallelFor(0, groups(), [&] (size_type first, size_type last) {
+                Storage<value_type> group{groupSize(), uninitialized};
+                alignas(cacheLineSize) value_type res[lanes];
+                for (size_type g = first; g < last; ++g) {
+                    std::copy_n(std::addressof(buffer_[g * groupSize()]), groupSize(), group.data());
+                    detGroup(group.data(), res);
+                    size_type count = std::min(lanes, count_ - g * lanes);
+                    std::copy_n(res, count, dets.begin() + g * lanes);
+                }
+            });
+        } else {
+            ThreadPool::instance().parallelFor(0, count_, [&] (size_type first, size_type last) {
+                for (size_type k = first; k < last; ++k) {
+                    dets[k] = get(k).det();
+                }
+            });
+        }
+        return dets;
+    }
+};
+
+template<typename T>
+std::vector<T> detBatch(std::span<const Matrix<T>> mtxs) {
+    for (const auto& mtx: mtxs) {
+        if (!mtx.square() || mtx.rows() != mtxs.front().rows()) {
+            throw std::logic_error("DetBatch: matrices must be square and of the same size");
+        }
+    }
+    return MatrixBatch<T>{mtxs}.det();
+}
+
+} //namespace matrix
@@ -0,0 +1,348 @@
+#pragma once
+
+/*
+Fast matrix input/output.
+
+Binary format: 64-byte BinaryHeader (magic, version, dtype, layout, rows, cols,
+data offset) followed by the elements, which start at a 64-byte aligned offset.
+
+Function writeBinary(path, mtx). Writes matrix in binary format, row-major.
+
+Class MappedMatrix. Maps binary file with mmap and gives zero-copy read-only access
+to its elements. Functionality:
+    size_type rows()
+    size_type cols()
+    Layout layout()
+    const_pointer data()
+    ConstMatrixView view() - zero-copy view, honours the stored layout
+    value_type at(i, j)
+    Matrix toMatrix()
+
+Function readBinary<T>(path). Maps binary file of any dtype once and copies it, converting,
+into an owning Matrix<T>. MappedMatrix is the zero-copy way to read a file.
+The header is validated against the file size without overflow: a header whose
+rows * cols elements don't fit in the file is rejected.
+
+Class BlockReader. Text parser: reads the stream by big blocks and parses numbers
+with std::from_chars. It owns the rest of the stream, since it reads ahead.
+
+Function isBinaryFile(path). Checks the magic.
+*/
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "Matrix.hpp"
+
+namespace matrix {
+
+enum class DType: std::uint32_t
+{
+    Int32,
+    Int64,
+    Float32,
+    Float64,
+};
+
+enum class Layout: std::uint32_t
+{
+    RowMajor,
+    ColMajor,
+};
+
+template<typename T>
+constexpr DType dtypeOf() {
+    if constexpr (std::is_same_v<T, float>) {
+        return DType::Float32;
+    } else if constexpr (std::is_same_v<T, double>) {
+        return DType::Float64;
+    } else if constexpr (std::is_integral_v<T> && sizeof(T) == 4U) {
+        return DType::Int32;
+    } else {
+        static_assert(std::is_integral_v<T> && sizeof(T) == 8U, "Unsupported binary value type");
+        return DType::Int64;
+    }
+}
+
+inline constexpr std::array<char, 8> binaryMagic{'M', 'A', 'T', 'R', 'I', 'X', 'B', '\0'};
+
+struct BinaryHeader
+{
+    std::array<char, 8> magic = binaryMagic;
+    std::uint32_t version = 1U;
+    DType dtype = DType::Float64;
+    Layout layout = Layout::RowMajor;
+    std::uint32_t reserved = 0U;
+    std::uint64_t rows = 0U;
+    std::uint64_t cols = 0U;
+    std::uint64_t dataOffset = sizeof(BinaryHeader);
+    std::uint64_t padding[2] = {0U, 0U};
+};
+
+static_assert(sizeof(BinaryHeader) == cacheLineSize, "Binary header must take one cache line");
+
+template<typename T, typename A>
+void writeBinary(const std::string& path, const Matrix<T, A>& mtx) {
+    std::ofstream os{path, std::ios::out | std::ios::binary};
+    if (!os) {
+        throw std::runtime_error("Can't open file " + path);
+    }
+    BinaryHeader header;
+    header.dtype = dtypeOf<T>();
+    header.rows = mtx.rows();
+    header.cols = mtx.cols();
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (std::size_t i = 0; i < mtx.rows(); ++i) {
+        os.write(reinterpret_cast<const char*>(mtx[i].data()), mtx.cols() * sizeof(T));
+    }
+    if (!os) {
+        throw std::runtime_error("Can't write file " + path);
+    }
+}
+
+class MappedFile final
+{
+    void* addr_ = MAP_FAILED;
+    std::size_t size_ = 0U;
+
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1) {
+            throw std::runtime_error("Can't open file " + path);
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) == -1 || st.st_size < static_cast<off_t>(sizeof(BinaryHeader))) {
+            ::close(fd);
+            throw std::runtime_error("Wrong binary file " + path);
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        addr_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr_ == MAP_FAILED) {
+            throw std::runtime_error("Can't map file " + path);
+        }
+        ::madvise(addr_, size_, MADV_SEQUENTIAL);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& rhs) noexcept {
+        std::swap(addr_, rhs.addr_);
+        std::swap(size_, rhs.size_);
+    }
+
+    MappedFile& operator=(MappedFile&& rhs) noexcept {
+        std::swap(addr_, rhs.addr_);
+        std::swap(size_, rhs.size_);
+        return *this;
+    }
+
+    ~MappedFile() {
+        if (addr_ != MAP_FAILED) {
+            ::munmap(addr_, size_);
+        }
+    }
+
+    const char* data() const {
+        return static_cast<const char*>(addr_);
+    }
+
+    std::size_t size() const {
+        return size_;
+    }
+
+    const BinaryHeader& header() const {
+        const BinaryHeader& header = *reinterpret_cast<const BinaryHeader*>(data());
+        if (header.magic != binaryMagic || header.version != 1U) {
+            throw std::runtime_error("Wrong binary file magic");
+        }
+        return header;
+    }
+};
+
+template<typename T>
+class MappedMatrix final
+{
+    using value_type = T;
+    using size_type = std::size_t;
+    using const_pointer = const T *;
+
+    MappedFile file_;
+    const BinaryHeader* header_ = nullptr;
+
+    //rows * cols <= (size - offset) / sizeof(T) is checked by division, nothing can overflow.
+    void validate() const {
+        if (header_->dtype != dtypeOf<value_type>()) {
+            throw std::runtime_error("Binary file dtype doesn't match value type");
+        }
+        std::uint64_t offset = header_->dataOffset;
+        if (offset % cacheLineSize != 0U || offset < sizeof(BinaryHeader) || offset > file_.size()) {
+            throw std::runtime_error("Wrong binary file data offset");
+        }
+        std::uint64_t maxElements = (file_.size() - offset) / sizeof(value_type);
+        if (header_->cols != 0U && header_->rows > maxElements / header_->cols) {
+            throw std::runtime_error("Binary file is truncated");
+        }
+    }
+
+public:
+    explicit MappedMatrix(const std::string& path):
+        MappedMatrix(MappedFile{path}) {}
+
+    explicit MappedMatrix(MappedFile file):
+        file_(std::move(file)), header_(std::addressof(file_.header())) {
+        validate();
+    }
+
+    size_type rows() const {
+        return header_->rows;
+    }
+
+    size_type cols() const {
+        return header_->cols;
+    }
+
+    Layout layout() const {
+        return header_->layout;
+    }
+
+    const_pointer data() const {
+        return reinterpret_cast<const_pointer>(file_.data() + header_->dataOffset);
+    }
+
+    ConstMatrixView<value_type> view() const {
+        if (layout() == Layout::RowMajor) {
+            return ConstMatrixView<value_type>{data(), rows(), cols(), cols(), 1U};
+        }
+        return ConstMatrixView<value_type>{data(), rows(), cols(), 1U, rows()};
+    }
+
+    value_type at(size_type i, size_type j) const {
+        if (i >= rows() || j >= cols()) {
+            throw std::out_of_range("At: index is out of range");
+        }
+        return layout() == Layout::RowMajor ? data()[i * cols() + j] : data()[j * rows() + i];
+    }
+
+    template<typename U = value_type>
+    Matrix<U> toMatrix() const {
+        Matrix<U> res{rows(), cols(), uninitialized};
+        for (size_type i = 0; i < rows(); ++i) {
+            U* row = res[i].data();
+            if (layout() == Layout::RowMajor) {
+                std::copy_n(data() + i * cols(), cols(), row);
+            } else {
+                for (size_type j = 0; j < cols(); ++j) {
+                    row[j] = data()[j * rows() + i];
+                }
+            }
+        }
+        return res;
+    }
+};
+
+template<typename T>
+Matrix<T> readBinary(const std::string& path) {
+    MappedFile file{path};
+    switch (file.header().dtype) {
+        case DType::Int32:
+            return MappedMatrix<std::int32_t>{std::move(file)}.template toMatrix<T>();
+        case DType::Int64:
+            return MappedMatrix<std::int64_t>{std::move(file)}.template toMatrix<T>();
+        case DType::Float32:
+            return MappedMatrix<float>{std::move(file)}.template toMatrix<T>();
+        case DType::Float64:
+            return MappedMatrix<double>{std::move(file)}.template toMatrix<T>();
+    }
+    throw std::runtime_error("Unknown binary file dtype");
+}
+
+inline bool isBinaryFile(const std::string& path) {
+    std::ifstream is{path, std::ios::in | std::ios::binary};
+    std::array<char, 8> magic{};
+    is.read(magic.data(), magic.size());
+    return is && magic == binaryMagic;
+}
+
+class BlockReader final
+{
+    using size_type = std::size_t;
+
+    static constexpr size_type blockSize = 1U << 16U;
+
+    std::istream& is_;
+    std::vector<char> buffer_;
+    size_type pos_ = 0U;
+    size_type end_ = 0U;
+    bool eof_ = false;
+
+    void refill() {
+        size_type rest = end_ - pos_;
+        std::memmove(buffer_.data(), buffer_.data() + pos_, rest);
+        pos_ = 0U;
+        end_ = rest;
+        auto wanted = static_cast<std::streamsize>(buffer_.size() - end_);
+        auto got = is_.rdbuf()->sgetn(buffer_.data() + end_, wanted);
+        end_ += static_cast<size_type>(got);
+        eof_ = got < wanted;
+    }
+
+    void skipSpaces() {
+        while (true) {
+            while (pos_ != end_ && std::isspace(static_cast<unsigned char>(buffer_[pos_]))) {
+                pos_++;
+            }
+            if (pos_ != end_ || eof_) {
+                return;
+            }
+            refill();
+        }
+    }
+
+public:
+    explicit BlockReader(std::istream& is):
+        is_(is), buffer_(blockSize) {}
+
+    template<typename T>
+    T next() requires std::is_arithmetic_v<T> {
+        skipSpaces();
+        if (!eof_ && end_ - pos_ < maxTokenSize) {
+            refill();
+        }
+        const char* first = buffer_.data() + pos_;
+        const char* last = buffer_.data() + end_;
+        if (first != last && *first == '+') {
+            first++;
+        }
+        T value{};
+        auto [ptr, ec] = std::from_chars(first, last, value);
+        if (ec != std::errc{} || (ptr != last && !std::isspace(static_cast<unsigned char>(*ptr)))) {
+            throw std::runtime_error("Can't parse number");
+        }
+        if (ptr == last && !eof_) {
+            throw std::runtime_error("Number is longer than the read block");
+        }
+        pos_ = static_cast<size_type>(ptr - buffer_.data());
+        return value;
+    }
+
+    template<typename T, typename A>
+    void read(Matrix<T, A>& mtx) {
+        for (size_type i = 0; i < mtx.rows(); ++i) {
+            T* row = mtx[i].data();
+            for (size_type j = 0; j < mtx.cols(); ++j) {
+                row[j] = next<T>();
+            }
+        }
+    }
+};
+
+} //namespace matrix
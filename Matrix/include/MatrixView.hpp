@@ -0,0 +1,205 @@
+#pragma once
+
+/*
+Class MatrixView. Non-owning view of matrix elements: pointer, rows, cols and strides
+between rows and between columns. MatrixView<const T> (ConstMatrixView<T>) is read-only.
+Slicing never copies data. Functionality:
+    operator[]                 - bounds-checked row proxy, as in Matrix
+    operator()(i, j)           - unchecked element access
+    size_type rows()
+    size_type cols()
+    bool square()
+    bool empty()
+    MatrixView block(i, j, m, n) - O(1) submatrix
+    MatrixView row(i)          - O(1) 1 x n view
+    MatrixView col(j)          - O(1) m x 1 view
+    MatrixView transposed()    - O(1), strides are swapped
+    void assign(view)          - copy elements from another view of the same size
+    void fill(value)
+    operator+=, operator-=, operator*=, operator/=
+*/
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+namespace matrix {
+
+template<typename T>
+class MatrixView;
+
+template<typename T>
+using ConstMatrixView = MatrixView<const T>;
+
+template<typename T>
+class MatrixView final
+{
+public:
+    using value_type = std::remove_const_t<T>;
+    using size_type = std::size_t;
+    using pointer = T *;
+    using reference = T &;
+
+private:
+    pointer data_ = nullptr;
+    size_type m_ = 0U;
+    size_type n_ = 0U;
+    size_type rowStride_ = 0U;
+    size_type colStride_ = 1U;
+
+    class ViewRow
+    {
+        pointer row_ = nullptr;
+        size_type n_ = 0U;
+        size_type stride_ = 1U;
+
+    public:
+        ViewRow(pointer row, size_type n, size_type stride):
+            row_(row), n_(n), stride_(stride) {}
+
+        reference operator[](size_type indx) const {
+            if (indx >= n_) {
+                throw std::out_of_range("Operator[]: index >= n");
+            }
+            return row_[indx * stride_];
+        }
+
+        size_type size() const {
+            return n_;
+        }
+    };
+
+    template<typename U, typename Op>
+    MatrixView& apply(MatrixView<U> rhs, Op op) {
+        if (m_ != rhs.rows() || n_ != rhs.cols()) {
+            throw std::logic_error("View operator: sizes don't match");
+        }
+        for (size_type i = 0; i < m_; ++i) {
+            pointer dst = data_ + i * rowStride_;
+            const value_type* src = rhs.data() + i * rhs.rowStride();
+            if (colStride_ == 1U && rhs.colStride() == 1U) {
+                for (size_type j = 0; j < n_; ++j) {
+                    op(dst[j], src[j]);
+                }
+            } else {
+                for (size_type j = 0; j < n_; ++j) {
+                    op(dst[j * colStride_], src[j * rhs.colStride()]);
+                }
+            }
+        }
+        return *this;
+    }
+
+    template<typename Op>
+    MatrixView& apply(Op op) {
+        for (size_type i = 0; i < m_; ++i) {
+            pointer dst = data_ + i * rowStride_;
+            for (size_type j = 0; j < n_; ++j) {
+                op(dst[j * colStride_]);
+            }
+        }
+        return *this;
+    }
+
+public:
+    MatrixView() = default;
+
+    MatrixView(pointer data, size_type m, size_type n, size_type ld):
+        data_(data), m_(m), n_(n), rowStride_(ld), colStride_(1U) {}
+
+    MatrixView(pointer data, size_type m, size_type n, size_type rowStride, size_type colStride):
+        data_(data), m_(m), n_(n), rowStride_(rowStride), colStride_(colStride) {}
+
+    template<typename U>
+    requires (std::is_const_v<T> && std::is_same_v<const U, T>)
+    MatrixView(const MatrixView<U>& rhs):
+        data_(rhs.data()), m_(rhs.rows()), n_(rhs.cols()),
+        rowStride_(rhs.rowStride()), colStride_(rhs.colStride()) {}
+
+    pointer data() const {
+        return data_;
+    }
+
+    size_type rows() const {
+        return m_;
+    }
+
+    size_type cols() const {
+        return n_;
+    }
+
+    size_type rowStride() const {
+        return rowStride_;
+    }
+
+    size_type colStride() const {
+        return colStride_;
+    }
+
+    bool square() const {
+        return m_ == n_;
+    }
+
+    bool empty() const {
+        return n_ == 0U || m_ == 0U;
+    }
+
+    reference operator()(size_type i, size_type j) const {
+        return data_[i * rowStride_ + j * colStride_];
+    }
+
+    ViewRow operator[](size_type indx) const {
+        if (indx >= m_) {
+            throw std::out_of_range("Operator[]: index >= m");
+        }
+        return ViewRow{data_ + indx * rowStride_, n_, colStride_};
+    }
+
+    MatrixView block(size_type i, size_type j, size_type m, size_type n) const {
+        if (i + m > m_ || j + n > n_) {
+            throw std::out_of_range("Block: block is out of range");
+        }
+        return MatrixView{data_ + i * rowStride_ + j * colStride_, m, n, rowStride_, colStride_};
+    }
+
+    MatrixView row(size_type i) const {
+        return block(i, 0, 1, n_);
+    }
+
+    MatrixView col(size_type j) const {
+        return block(0, j, m_, 1);
+    }
+
+    MatrixView transposed() const {
+        return MatrixView{data_, n_, m_, colStride_, rowStride_};
+    }
+
+    template<typename U>
+    MatrixView& assign(MatrixView<U> rhs) requires (!std::is_const_v<T>) {
+        return apply(rhs, [] (value_type& lhs, const value_type& rhs) { lhs = rhs; });
+    }
+
+    MatrixView& fill(const value_type& value) requires (!std::is_const_v<T>) {
+        return apply([&value] (value_type& lhs) { lhs = value; });
+    }
+
+    template<typename U>
+    MatrixView& operator+=(MatrixView<U> rhs) requires (!std::is_const_v<T>) {
+        return apply(rhs, [] (value_type& lhs, const value_type& rhs) { lhs += rhs; });
+    }
+
+    template<typename U>
+    MatrixView& operator-=(MatrixView<U> rhs) requires (!std::is_const_v<T>) {
+        return apply(rhs, [] (value_type& lhs, const value_type& rhs) { lhs -= rhs; });
+    }
+
+    MatrixView& operator*=(const value_type& rhs) requires (!std::is_const_v<T>) {
+        return apply([&rhs] (value_type& lhs) { lhs *= rhs; });
+    }
+
+    MatrixView& operator/=(const value_type& rhs) requires (!std::is_const_v<T>) {
+        return apply([&rhs] (value_type& lhs) { lhs /= rhs; });
+    }
+};
+
+} //namespace matrix
@@ -0,0 +1,400 @@
+#pragma once
+
+/*
+Exact determinant of integer matrices by multi-modular arithmetic.
+
+Class Montgomery. Arithmetic modulo odd p < 2^62 in Montgomery form: product is
+one 128-bit multiplication plus REDC, no division.
+
+Function modularPrimes(count). First count primes below 2^62 (deterministic Miller-Rabin).
+
+Function detModulo(n, rowAccess, mont). det mod p by Gaussian elimination, p is prime.
+
+Function detMultiModular<T>(n, rowAccess). Hadamard bound tells how many primes are
+needed (but no more than T can hold plus one check prime); determinants modulo
+different primes are computed in parallel and combined by Garner's algorithm with
+symmetric digits, which yields the signed result. Throws std::overflow_error if the
+determinant doesn't fit in T. A result is exact when the bound needs no more primes
+than T can hold; otherwise the overflow check is Monte Carlo: the one check prime lets
+an overflow pass with probability about 2^-61.
+
+Function detMultiModularDecimal<T>(n, rowAccess). Exact determinant of any size as a
+decimal string: every prime the Hadamard bound asks for is used, the Garner digits are
+summed into a big integer of 32-bit limbs and printed.
+*/
+
+#include <cmath>
+#include <mutex>
+#include <string>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include "ThreadPool.hpp"
+
+namespace matrix {
+
+using u64 = std::uint64_t;
+__extension__ typedef unsigned __int128 u128;
+__extension__ typedef __int128 i128;
+
+class Montgomery final
+{
+    u64 mod_ = 0U;
+    u64 negInv_ = 0U;
+    u64 r2_ = 0U;
+
+public:
+    explicit Montgomery(u64 mod):
+        mod_(mod) {
+        u64 inv = mod;
+        for (int i = 0; i < 5; ++i) {
+            inv *= 2U - mod * inv;
+        }
+        negInv_ = ~inv + 1U;
+        r2_ = static_cast<u64>(((~u128{0}) % mod + 1U) % mod);
+    }
+
+    u64 mod() const {
+        return mod_;
+    }
+
+    u64 reduce(u128 x) const {
+        u64 q = static_cast<u64>(x) * negInv_;
+        u64 t = static_cast<u64>((x + static_cast<u128>(q) * mod_) >> 64);
+        return t >= mod_ ? t - mod_ : t;
+    }
+
+    u64 toMont(u64 x) const {
+        return reduce(static_cast<u128>(x) * r2_);
+    }
+
+    u64 fromMont(u64 x) const {
+        return reduce(x);
+    }
+
+    u64 mul(u64 lhs, u64 rhs) const {
+        return reduce(static_cast<u128>(lhs) * rhs);
+    }
+
+    u64 add(u64 lhs, u64 rhs) const {
+        u64 res = lhs + rhs;
+        return res >= mod_ ? res - mod_ : res;
+    }
+
+    u64 sub(u64 lhs, u64 rhs) const {
+        return lhs >= rhs ? lhs - rhs : lhs + mod_ - rhs;
+    }
+
+    u64 pow(u64 base, u64 exp) const {
+        u64 res = toMont(1U);
+        while (exp) {
+            if (exp & 1U) {
+                res = mul(res, base);
+            }
+            base = mul(base, base);
+            exp >>= 1U;
+        }
+        return res;
+    }
+
+    u64 inv(u64 x) const {
+        return pow(x, mod_ - 2U);
+    }
+};
+
+inline u64 mulMod(u64 lhs, u64 rhs, u64 mod) {
+    return static_cast<u64>(static_cast<u128>(lhs) * rhs % mod);
+}
+
+inline u64 powMod(u64 base, u64 exp, u64 mod) {
+    u64 res = 1U;
+    base %= mod;
+    while (exp) {
+        if (exp & 1U) {
+            res = mulMod(res, base, mod);
+        }
+        base = mulMod(base, base, mod);
+        exp >>= 1U;
+    }
+    return res;
+}
+
+inline bool isPrime(u64 n) {
+    if (n < 2U) {
+        return false;
+    }
+    for (u64 p: {2U, 3U, 5U, 7U, 11U, 13U, 17U, 19U, 23U, 29U, 31U, 37U}) {
+        if (n % p == 0U) {
+            return n == p;
+        }
+    }
+    u64 d = n - 1U;
+    int s = 0;
+    while ((d & 1U) == 0U) {
+        d >>= 1U;
+        s++;
+    }
+    for (u64 a: {2U, 325U, 9375U, 28178U, 450775U, 9780504U, 1795265022U}) {
+        u64 x = powMod(a, d, n);
+        if (x == 0U || x == 1U || x == n - 1U) {
+            continue;
+        }
+        bool composite = true;
+        for (int r = 1; r < s && composite; ++r) {
+            x = mulMod(x, x, n);
+            composite = x != n - 1U;
+        }
+        if (composite) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline std::vector<u64> modularPrimes(std::size_t count) {
+    static std::vector<u64> primes;
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock{mutex};
+    u64 candidate = primes.empty() ? (u64{1} << 62) - 1U : primes.back() - 2U;
+    while (primes.size() < count) {
+        if (isPrime(candidate)) {
+            primes.push_back(candidate);
+        }
+        candidate -= 2U;
+    }
+    return std::vector<u64>(primes.begin(), primes.begin() + count);
+}
+
+template<typename T, typename F>
+u64 detModulo(std::size_t n, F rowAccess, const Montgomery& mont) {
+    u64 mod = mont.mod();
+    std::vector<u64> mtx(n * n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const T* row = rowAccess(i);
+        for (std::size_t j = 0; j < n; ++j) {
+            i128 value = static_cast<i128>(row[j]) % static_cast<i128>(mod);
+            if (value < 0) {
+                value += mod;
+            }
+            mtx[i * n + j] = mont.toMont(static_cast<u64>(value));
+        }
+    }
+    u64 det = mont.toMont(1U);
+    for (std::size_t k = 0; k < n; ++k) {
+        std::size_t pivot = k;
+        while (pivot < n && mtx[pivot * n + k] == 0U) {
+            pivot++;
+        }
+        if (pivot == n) {
+            return 0U;
+        }
+        if (pivot != k) {
+            std::swap_ranges(mtx.begin() + pivot * n + k, mtx.begin() + (pivot + 1) * n, mtx.begin() + k * n + k);
+            det = mont.sub(0U, det);
+        }
+        const u64* rowK = mtx.data() + k * n;
+        det = mont.mul(det, rowK[k]);
+        u64 inv = mont.inv(rowK[k]);
+        for (std::size_t i = k + 1; i < n; ++i) {
+            u64* rowI = mtx.data() + i * n;
+            if (rowI[k] == 0U) {
+                continue;
+            }
+            u64 coef = mont.mul(rowI[k], inv);
+            for (std::size_t j = k + 1; j < n; ++j) {
+                rowI[j] = mont.sub(rowI[j], mont.mul(coef, rowK[j]));
+            }
+        }
+    }
+    return mont.fromMont(det);
+}
+
+namespace detail {
+
+//log2 of the Hadamard bound prod |row_i|, -infinity if a row is zero.
+template<typename T, typename F>
+double detLog2Bound(std::size_t n, F rowAccess) {
+    double log2Bound = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const T* row = rowAccess(i);
+        double norm2 = 0.0;
+        for (std::size_t j = 0; j < n; ++j) {
+            norm2 += static_cast<double>(row[j]) * static_cast<double>(row[j]);
+        }
+        log2Bound += 0.5 * std::log2(norm2);
+    }
+    return log2Bound;
+}
+
+inline constexpr double bitsPerPrime = 61.0;
+
+//Primes whose product exceeds 2 |det|, so that the symmetric residue is the determinant.
+inline std::size_t primesForBits(double bits) {
+    return static_cast<std::size_t>(std::ceil((bits + 2.0) / bitsPerPrime));
+}
+
+template<typename T, typename F>
+std::vector<u64> detResidues(std::size_t n, F rowAccess, const std::vector<u64>& primes) {
+    std::vector<u64> residues(primes.size());
+    ThreadPool::instance().parallelFor(0, primes.size(), [&] (std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            residues[i] = detModulo<T>(n, rowAccess, Montgomery{primes[i]});
+        }
+    });
+    return residues;
+}
+
+//Garner's mixed-radix digits: x = sum digits[i] prod_{j < i} primes[j]. Symmetric digits
+//lie in (-p/2, p/2] and give the solution of least magnitude, otherwise digits lie in
+//[0, p) and give the solution in [0, prod primes).
+inline std::vector<i128> garnerDigits(const std::vector<u64>& residues, const std::vector<u64>& primes, bool symmetric) {
+    std::vector<i128> digits(primes.size());
+    for (std::size_t i = 0; i < primes.size(); ++i) {
+        u64 mod = primes[i];
+        u64 value = 0U;
+        u64 radix = 1U;
+        for (std::size_t j = 0; j < i; ++j) {
+            i128 digit = digits[j] % static_cast<i128>(mod);
+            u64 digitMod = static_cast<u64>(digit < 0 ? digit + mod : digit);
+            value = (value + mulMod(digitMod, radix, mod)) % mod;
+            radix = mulMod(radix, primes[j] % mod, mod);
+        }
+        u64 diff = (residues[i] + mod - value) % mod;
+        u64 digit = mulMod(diff, powMod(radix, mod - 2U, mod), mod);
+        digits[i] = symmetric && digit > mod / 2U ? static_cast<i128>(digit) - mod : static_cast<i128>(digit);
+    }
+    return digits;
+}
+
+//Non-negative big integer, little-endian 32-bit limbs, no leading zero limbs.
+using Limbs = std::vector<std::uint32_t>;
+
+inline void mulAdd(Limbs& x, u64 mul, u64 add) {
+    u128 carry = add;
+    for (std::uint32_t& limb: x) {
+        u128 cur = static_cast<u128>(limb) * mul + carry;
+        limb = static_cast<std::uint32_t>(cur);
+        carry = cur >> 32U;
+    }
+    for (; carry != 0U; carry >>= 32U) {
+        x.push_back(static_cast<std::uint32_t>(carry));
+    }
+    while (!x.empty() && x.back() == 0U) {
+        x.pop_back();
+    }
+}
+
+inline int compare(const Limbs& lhs, const Limbs& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return lhs.size() < rhs.size() ? -1 : 1;
+    }
+    for (std::size_t i = lhs.size(); i-- > 0;) {
+        if (lhs[i] != rhs[i]) {
+            return lhs[i] < rhs[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+//lhs - rhs for lhs >= rhs
+inline Limbs subtract(Limbs lhs, const Limbs& rhs) {
+    std::int64_t borrow = 0;
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        std::int64_t cur = static_cast<std::int64_t>(lhs[i]) - borrow - (i < rhs.size() ? rhs[i] : 0U);
+        borrow = cur < 0 ? 1 : 0;
+        lhs[i] = static_cast<std::uint32_t>(cur + (borrow << 32U));
+    }
+    while (!lhs.empty() && lhs.back() == 0U) {
+        lhs.pop_back();
+    }
+    return lhs;
+}
+
+inline std::string toDecimal(Limbs x) {
+    constexpr std::uint32_t chunk = 1000000000U;
+    std::string res;
+    while (!x.empty()) {
+        u64 rest = 0U;
+        for (std::size_t i = x.size(); i-- > 0;) {
+            u64 cur = (rest << 32U) | x[i];
+            x[i] = static_cast<std::uint32_t>(cur / chunk);
+            rest = cur % chunk;
+        }
+        while (!x.empty() && x.back() == 0U) {
+            x.pop_back();
+        }
+        for (int d = 0; d < 9 && (rest != 0U || !x.empty()); ++d) {
+            res.push_back(static_cast<char>('0' + rest % 10U));
+            rest /= 10U;
+        }
+    }
+    if (res.empty()) {
+        res = "0";
+    }
+    std::reverse(res.begin(), res.end());
+    return res;
+}
+
+} //namespace detail
+
+template<typename T, typename F>
+T detMultiModular(std::size_t n, F rowAccess) requires std::is_integral_v<T> {
+    double log2Bound = detail::detLog2Bound<T>(n, rowAccess);
+    if (std::isinf(log2Bound)) {
+        return T{0};
+    }
+    std::size_t boundPrimes = detail::primesForBits(log2Bound);
+    std::size_t valuePrimes = detail::primesForBits(std::numeric_limits<T>::digits);
+    std::size_t nPrimes = std::min(boundPrimes, valuePrimes + 1U);
+    std::vector<u64> primes = modularPrimes(nPrimes);
+    std::vector<i128> digits = detail::garnerDigits(detail::detResidues<T>(n, rowAccess, primes), primes, true);
+
+    //A determinant that fits in T has zero digits starting from valuePrimes. When the
+    //Hadamard bound needs more primes than that, one extra prime verifies it: an
+    //overflow goes unnoticed only if its digit vanishes by chance, with probability ~2^-61.
+    for (std::size_t i = valuePrimes; i < nPrimes; ++i) {
+        if (digits[i] != 0) {
+            throw std::overflow_error("Det: result doesn't fit in value type");
+        }
+    }
+    i128 det = 0;
+    i128 radix = 1;
+    for (std::size_t i = 0; i < std::min(nPrimes, valuePrimes); ++i) {
+        det += digits[i] * radix;
+        radix *= primes[i];
+    }
+    if (det > static_cast<i128>(std::numeric_limits<T>::max()) ||
+        det < static_cast<i128>(std::numeric_limits<T>::min())) {
+        throw std::overflow_error("Det: result doesn't fit in value type");
+    }
+    return static_cast<T>(det);
+}
+
+template<typename T, typename F>
+std::string detMultiModularDecimal(std::size_t n, F rowAccess) requires std::is_integral_v<T> {
+    double log2Bound = detail::detLog2Bound<T>(n, rowAccess);
+    if (std::isinf(log2Bound)) {
+        return "0";
+    }
+    std::vector<u64> primes = modularPrimes(detail::primesForBits(log2Bound));
+    std::vector<i128> digits = detail::garnerDigits(detail::detResidues<T>(n, rowAccess, primes), primes, false);
+    //x in [0, M) by Horner over the digits; det = x if 2x < M, else x - M
+    detail::Limbs x;
+    detail::Limbs modulus{1U};
+    for (std::size_t i = primes.size(); i-- > 0;) {
+        detail::mulAdd(x, primes[i], static_cast<u64>(digits[i]));
+        detail::mulAdd(modulus, primes[i], 0U);
+    }
+    detail::Limbs twice = x;
+    detail::mulAdd(twice, 2U, 0U);
+    if (detail::compare(twice, modulus) < 0) {
+        return detail::toDecimal(std::move(x));
+    }
+    return "-" + detail::toDecimal(detail::subtract(std::move(modulus), x));
+}
+
+} //namespace matrix
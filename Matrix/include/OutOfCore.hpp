@@ -0,0 +1,797 @@
+#pragma once
+
+/*
+Out-of-core matrices: the elements live in a file, split into square tiles, and only a
+bounded number of tiles is kept in memory.
+
+Tiled format: 64-byte TiledHeader (magic, version, dtype, rows, cols, tile, data
+offset), then the tiles in row-major order of tiles. Every tile takes tile * tile
+elements, row-major; edge tiles are padded with zeros.
+
+Class TileCache. LRU cache of tiles of one file with a capacity in tiles. A tile is
+pinned while somebody holds a Tile handle to it; only unpinned tiles are evicted,
+dirty ones are written back first. File reads are done without the lock, so a load on
+one thread overlaps with computations on others. A prefetch holds its slot only while
+the tile is in flight; an acquire that finds no free slot waits for the loads in flight
+and throws std::runtime_error only if every tile is pinned by Tile handles.
+
+Class OutOfCoreMatrix. Functionality:
+    OutOfCoreMatrix(path, rows, cols, tile, cacheTiles) - creates a zero file
+    OutOfCoreMatrix(path, cacheTiles)                    - opens an existing file
+    size_type rows(), cols(), tileSize(), tileRows(), tileCols(), cacheTiles()
+    Tile tile(ti, tj, write = false) - pinned tile, view() gives its elements
+    void prefetch(ti, tj)            - loads the tile on the I/O thread
+    void assign(view), Matrix toMatrix()
+    void flush()                     - writes back dirty tiles
+    size_type loads()                - tiles read from the file so far
+
+Function gemm(a, b, c). c += a * b tile by tile. The C tile stays pinned while a row
+of A tiles and a column of B tiles stream by; the next pair is prefetched while the
+current one is multiplied. Rows of C are walked in snake order, so A tiles of a row
+and B tiles at the turns are reused from the cache. Every operand needs a cache of at
+least gemmMinCacheTiles tiles: the one in use and the prefetched next one.
+
+Class TiledLU. Left-looking LU of an OutOfCoreMatrix in place. For every tile column
+the earlier pivots and updates are applied, then the column is factorized with partial
+pivoting over all its rows. Pivoting is per tile column: swaps are not applied back
+to the L tiles of earlier columns (as in LINPACK), solve() replays them in the same
+order. Needs a cache of tileRows() + 3 tiles, since a tile column is pinned while it
+is factorized. Functionality:
+    bool singular()
+    value_type det()
+    std::vector<T> solve(b)   - throws std::runtime_error if the matrix is singular
+    const std::vector<size_type>& pivots() - row g was swapped with row pivots()[g]
+*/
+
+#include <list>
+#include <deque>
+#include <mutex>
+#include <array>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <unordered_map>
+#include <condition_variable>
+#include <fcntl.h>
+#include <unistd.h>
+#include "Matrix.hpp"
+#include "MatrixIO.hpp"
+#include "Gemm.hpp"
+#include "ThreadPool.hpp"
+
+namespace matrix {
+
+inline constexpr std::size_t gemmMinCacheTiles = 2U;
+
+inline constexpr std::array<char, 8> tiledMagic{'M', 'A', 'T', 'R', 'I', 'X', 'T', '\0'};
+
+struct TiledHeader
+{
+    std::array<char, 8> magic = tiledMagic;
+    std::uint32_t version = 1U;
+    DType dtype = DType::Float64;
+    std::uint64_t rows = 0U;
+    std::uint64_t cols = 0U;
+    std::uint64_t tile = 0U;
+    std::uint64_t dataOffset = sizeof(TiledHeader);
+    std::uint64_t padding[2] = {0U, 0U};
+};
+
+static_assert(sizeof(TiledHeader) == cacheLineSize, "Tiled header must take one cache line");
+
+class TileFile final
+{
+    int fd_ = -1;
+
+public:
+    TileFile(const std::string& path, bool create) {
+        fd_ = ::open(path.c_str(), create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR, 0644);
+        if (fd_ == -1) {
+            throw std::runtime_error("Can't open file " + path);
+        }
+    }
+
+    TileFile(const TileFile&) = delete;
+    TileFile& operator=(const TileFile&) = delete;
+
+    ~TileFile() {
+        ::close(fd_);
+    }
+
+    void read(void* dst, std::size_t size, std::uint64_t offset) const {
+        auto* bytes = static_cast<char*>(dst);
+        while (size > 0U) {
+            ssize_t done = ::pread(fd_, bytes, size, static_cast<off_t>(offset));
+            if (done <= 0) {
+                throw std::runtime_error("Can't read tile");
+            }
+            bytes += done;
+            size -= static_cast<std::size_t>(done);
+            offset += static_cast<std::uint64_t>(done);
+        }
+    }
+
+    void write(const void* src, std::size_t size, std::uint64_t offset) {
+        const auto* bytes = static_cast<const char*>(src);
+        while (size > 0U) {
+            ssize_t done = ::pwrite(fd_, bytes, size, static_cast<off_t>(offset));
+            if (done <= 0) {
+                throw std::runtime_error("Can't write tile");
+            }
+            bytes += done;
+            size -= static_cast<std::size_t>(done);
+            offset += static_cast<std::uint64_t>(done);
+        }
+    }
+
+    void resize(std::uint64_t size) {
+        if (::ftruncate(fd_, static_cast<off_t>(size)) == -1) {
+            throw std::runtime_error("Can't resize tiled file");
+        }
+    }
+};
+
+template<typename T>
+class TileCache final
+{
+    using value_type = T;
+    using size_type = std::size_t;
+
+    struct Entry
+    {
+        size_type index = 0U;
+        Storage<value_type> data;
+        size_type pins = 0U;
+        bool ready = false;
+        bool failed = false;
+        bool dirty = false;
+    };
+
+    using EntryIt = typename std::list<Entry>::iterator;
+
+    TileFile& file_;
+    size_type tileElems_;
+    std::uint64_t dataOffset_;
+    size_type capacity_;
+    std::list<Entry> lru_;
+    std::unordered_map<size_type, EntryIt> map_;
+    std::vector<Storage<value_type>> spare_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    size_type loads_ = 0U;
+    size_type inFlight_ = 0U;
+
+    std::uint64_t offsetOf(size_type index) const {
+        return dataOffset_ + static_cast<std::uint64_t>(index) * tileElems_ * sizeof(value_type);
+    }
+
+    void writeBack(Entry& entry) {
+        file_.write(entry.data.data(), tileElems_ * sizeof(value_type), offsetOf(entry.index));
+        entry.dirty = false;
+    }
+
+    //Called under the lock. Returns false if every cached tile is pinned.
+    bool makeRoom() {
+        if (lru_.size() < capacity_) {
+            return true;
+        }
+        for (auto it = lru_.end(); it != lru_.begin();) {
+            --it;
+            if (it->pins == 0U && it->ready) {
+                if (it->dirty) {
+                    writeBack(*it);
+                }
+                map_.erase(it->index);
+                spare_.push_back(std::move(it->data));
+                lru_.erase(it);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //Returns the pinned entry. A prefetch (required is false) pins the tile only while it's
+    //loaded and returns lru_.end(); it does nothing if the tile is cached or there is no room.
+    //A required pin without room waits until the loads in flight finish and retries.
+    EntryIt pin(size_type index, bool required) {
+        std::unique_lock<std::mutex> lock{mutex_};
+        while (true) {
+            auto found = map_.find(index);
+            if (found != map_.end() && found->second->failed && found->second->pins == 0U) {
+                lru_.erase(found->second);
+                map_.erase(found);
+                found = map_.end();
+            }
+            if (found != map_.end()) {
+                EntryIt it = found->second;
+                lru_.splice(lru_.begin(), lru_, it);
+                if (!required) {
+                    return lru_.end();
+                }
+                it->pins++;
+                cv_.wait(lock, [it] { return it->ready; });
+                if (it->failed) {
+                    it->pins--;
+                    throw std::runtime_error("Can't read tile");
+                }
+                return it;
+            }
+            if (makeRoom()) {
+                break;
+            }
+            if (!required) {
+                return lru_.end();
+            }
+            if (inFlight_ == 0U) {
+                throw std::runtime_error("TileCache: every cached tile is pinned");
+            }
+            cv_.wait(lock);
+        }
+        Storage<value_type> data;
+        if (spare_.empty()) {
+            data = Storage<value_type>{tileElems_, uninitialized};
+        } else {
+            data = std::move(spare_.back());
+            spare_.pop_back();
+        }
+        lru_.push_front(Entry{index, std::move(data), 1U});
+        EntryIt it = lru_.begin();
+        map_.emplace(index, it);
+        inFlight_++;
+        lock.unlock();
+        bool failed = false;
+        try {
+            file_.read(it->data.data(), tileElems_ * sizeof(value_type), offsetOf(index));
+        } catch (const std::runtime_error&) {
+            failed = true;
+        }
+        lock.lock();
+        it->ready = true;
+        it->failed = failed;
+        inFlight_--;
+        loads_++;
+        if (failed || !required) {
+            it->pins--;
+        }
+        cv_.notify_all();
+        if (failed) {
+            throw std::runtime_error("Can't read tile");
+        }
+        return required ? it : lru_.end();
+    }
+
+    void unpin(EntryIt it, bool dirty) {
+        std::lock_guard<std::mutex> lock{mutex_};
+        it->pins--;
+        it->dirty = it->dirty || dirty;
+        if (it->pins == 0U) {
+            cv_.notify_all();
+        }
+    }
+
+public:
+    class Tile final
+    {
+        friend class TileCache;
+
+        TileCache* cache_ = nullptr;
+        EntryIt entry_{};
+        MatrixView<value_type> view_;
+        bool write_ = false;
+
+        Tile(TileCache* cache, EntryIt entry, MatrixView<value_type> view, bool write):
+            cache_(cache), entry_(entry), view_(view), write_(write) {}
+
+    public:
+        Tile(const Tile&) = delete;
+        Tile& operator=(const Tile&) = delete;
+
+        Tile(Tile&& rhs) noexcept:
+            cache_(std::exchange(rhs.cache_, nullptr)), entry_(rhs.entry_), view_(rhs.view_), write_(rhs.write_) {}
+
+        Tile& operator=(Tile&& rhs) noexcept {
+            std::swap(cache_, rhs.cache_);
+            std::swap(entry_, rhs.entry_);
+            std::swap(view_, rhs.view_);
+            std::swap(write_, rhs.write_);
+            return *this;
+        }
+
+        ~Tile() {
+            if (cache_ != nullptr) {
+                cache_->unpin(entry_, write_);
+            }
+        }
+
+        MatrixView<value_type> view() const {
+            return view_;
+        }
+    };
+
+    TileCache(TileFile& file, size_type tileElems, std::uint64_t dataOffset, size_type capacity):
+        file_(file), tileElems_(tileElems), dataOffset_(dataOffset), capacity_(capacity) {
+        if (capacity_ == 0U) {
+            throw std::logic_error("TileCache: capacity must be positive");
+        }
+    }
+
+    TileCache(const TileCache&) = delete;
+    TileCache& operator=(const TileCache&) = delete;
+
+    ~TileCache() {
+        try {
+            flush();
+        } catch (const std::runtime_error&) {}
+    }
+
+    size_type capacity() const {
+        return capacity_;
+    }
+
+    size_type loads() {
+        std::lock_guard<std::mutex> lock{mutex_};
+        return loads_;
+    }
+
+    //view is the part of the tile buffer that belongs to the matrix, its stride is the tile size.
+    Tile acquire(size_type index, size_type rows, size_type cols, size_type ld, bool write) {
+        EntryIt it = pin(index, true);
+        return Tile{this, it, MatrixView<value_type>{it->data.data(), rows, cols, ld}, write};
+    }
+
+    void prefetch(size_type index) {
+        pin(index, false);
+    }
+
+    void flush() {
+        std::lock_guard<std::mutex> lock{mutex_};
+        for (auto& entry: lru_) {
+            if (entry.ready && entry.dirty) {
+                writeBack(entry);
+            }
+        }
+    }
+};
+
+template<typename T>
+class OutOfCoreMatrix final
+{
+    using value_type = T;
+    using size_type = std::size_t;
+
+    TileFile file_;
+    TiledHeader header_;
+    TileCache<value_type> cache_;
+    std::thread io_;
+    std::mutex queueMutex_;
+    std::condition_variable queueCv_;
+    std::deque<size_type> queue_;
+    bool stop_ = false;
+
+    static TiledHeader makeHeader(size_type rows, size_type cols, size_type tile) {
+        if (tile == 0U) {
+            throw std::logic_error("OutOfCoreMatrix: tile size must be positive");
+        }
+        TiledHeader header;
+        header.dtype = dtypeOf<value_type>();
+        header.rows = rows;
+        header.cols = cols;
+        header.tile = tile;
+        return header;
+    }
+
+    static TiledHeader readHeader(const TileFile& file, const std::string& path) {
+        TiledHeader header;
+        file.read(&header, sizeof(header), 0U);
+        if (header.magic != tiledMagic || header.tile == 0U) {
+            throw std::runtime_error("Wrong tiled file " + path);
+        }
+        if (header.dtype != dtypeOf<value_type>()) {
+            throw std::runtime_error("Tiled file " + path + " has another value type");
+        }
+        return header;
+    }
+
+    void ioLoop() {
+        while (true) {
+            size_type index = 0U;
+            {
+                std::unique_lock<std::mutex> lock{queueMutex_};
+                queueCv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+                if (stop_) {
+                    return;
+                }
+                index = queue_.front();
+                queue_.pop_front();
+            }
+            try {
+                cache_.prefetch(index);
+            } catch (const std::runtime_error&) {
+                //The reader that needs the tile will get the error itself.
+            }
+        }
+    }
+
+    size_type extent(size_type total, size_type t) const {
+        return std::min(tileSize(), total - t * tileSize());
+    }
+
+    size_type indexOf(size_type ti, size_type tj) const {
+        if (ti >= tileRows() || tj >= tileCols()) {
+            throw std::out_of_range("OutOfCoreMatrix: tile index is out of range");
+        }
+        return ti * tileCols() + tj;
+    }
+
+public:
+    using Tile = typename TileCache<value_type>::Tile;
+
+    OutOfCoreMatrix(const std::string& path, size_type rows, size_type cols, size_type tile, size_type cacheTiles):
+        file_(path, true), header_(makeHeader(rows, cols, tile)),
+        cache_(file_, tile * tile, header_.dataOffset, cacheTiles) {
+        file_.write(&header_, sizeof(header_), 0U);
+        file_.resize(header_.dataOffset + static_cast<std::uint64_t>(tileRows()) * tileCols() * tile * tile * sizeof(value_type));
+        io_ = std::thread{[this] { ioLoop(); }};
+    }
+
+    OutOfCoreMatrix(const std::string& path, size_type cacheTiles):
+        file_(path, false), header_(readHeader(file_, path)),
+        cache_(file_, header_.tile * header_.tile, header_.dataOffset, cacheTiles) {
+        io_ = std::thread{[this] { ioLoop(); }};
+    }
+
+    OutOfCoreMatrix(const OutOfCoreMatrix&) = delete;
+    OutOfCoreMatrix& operator=(const OutOfCoreMatrix&) = delete;
+
+    ~OutOfCoreMatrix() {
+        {
+            std::lock_guard<std::mutex> lock{queueMutex_};
+            stop_ = true;
+        }
+        queueCv_.notify_all();
+        io_.join();
+    }
+
+    size_type rows() const {
+        return header_.rows;
+    }
+
+    size_type cols() const {
+        return header_.cols;
+    }
+
+    size_type tileSize() const {
+        return header_.tile;
+    }
+
+    size_type tileRows() const {
+        return (rows() + tileSize() - 1U) / tileSize();
+    }
+
+    size_type tileCols() const {
+        return (cols() + tileSize() - 1U) / tileSize();
+    }
+
+    size_type cacheTiles() const {
+        return cache_.capacity();
+    }
+
+    size_type loads() {
+        return cache_.loads();
+    }
+
+    Tile tile(size_type ti, size_type tj, bool write = false) {
+        size_type index = indexOf(ti, tj);
+        return cache_.acquire(index, extent(rows(), ti), extent(cols(), tj), tileSize(), write);
+    }
+
+    void prefetch(size_type ti, size_type tj) {
+        size_type index = indexOf(ti, tj);
+        {
+            std::lock_guard<std::mutex> lock{queueMutex_};
+            queue_.push_back(index);
+        }
+        queueCv_.notify_one();
+    }
+
+    void flush() {
+        cache_.flush();
+    }
+
+    void assign(ConstMatrixView<value_type> mtx) {
+        if (mtx.rows() != rows() || mtx.cols() != cols()) {
+            throw std::logic_error("OutOfCoreMatrix: sizes don't match");
+        }
+        for (size_type ti = 0; ti < tileRows(); ++ti) {
+            for (size_type tj = 0; tj < tileCols(); ++tj) {
+                Tile t = tile(ti, tj, true);
+                auto dst = t.view();
+                for (size_type i = 0; i < dst.rows(); ++i) {
+                    for (size_type j = 0; j < dst.cols(); ++j) {
+                        dst(i, j) = mtx(ti * tileSize() + i, tj * tileSize() + j);
+                    }
+                }
+            }
+        }
+    }
+
+    Matrix<value_type> toMatrix() {
+        Matrix<value_type> res{rows(), cols(), uninitialized};
+        for (size_type ti = 0; ti < tileRows(); ++ti) {
+            for (size_type tj = 0; tj < tileCols(); ++tj) {
+                Tile t = tile(ti, tj);
+                auto src = t.view();
+                for (size_type i = 0; i < src.rows(); ++i) {
+                    std::copy_n(&src(i, 0), src.cols(), &res[ti * tileSize() + i][tj * tileSize()]);
+                }
+            }
+        }
+        return res;
+    }
+};
+
+template<typename T>
+void gemm(OutOfCoreMatrix<T>& a, OutOfCoreMatrix<T>& b, OutOfCoreMatrix<T>& c) {
+    if (a.cols() != b.rows() || a.rows() != c.rows() || b.cols() != c.cols()) {
+        throw std::logic_error("Gemm: sizes don't match");
+    }
+    if (a.tileSize() != b.tileSize() || a.tileSize() != c.tileSize()) {
+        throw std::logic_error("Gemm: tile sizes don't match");
+    }
+    if (&c == &a || &c == &b) {
+        throw std::logic_error("Gemm: result overlaps an operand");
+    }
+    if (std::min({a.cacheTiles(), b.cacheTiles(), c.cacheTiles()}) < gemmMinCacheTiles) {
+        throw std::logic_error("Gemm: every cache must hold gemmMinCacheTiles tiles");
+    }
+    std::size_t nti = c.tileRows();
+    std::size_t ntj = c.tileCols();
+    std::size_t ntk = a.tileCols();
+    for (std::size_t i = 0; i < nti; ++i) {
+        for (std::size_t step = 0; step < ntj; ++step) {
+            std::size_t j = i % 2U == 0U ? step : ntj - 1U - step;
+            auto ct = c.tile(i, j, true);
+            for (std::size_t k = 0; k < ntk; ++k) {
+                if (k + 1U < ntk) {
+                    a.prefetch(i, k + 1U);
+                    b.prefetch(k + 1U, j);
+                } else if (step + 1U < ntj) {
+                    std::size_t next = i % 2U == 0U ? j + 1U : j - 1U;
+                    c.prefetch(i, next);
+                    b.prefetch(0U, next);
+                }
+                auto at = a.tile(i, k);
+                auto bt = b.tile(k, j);
+                gemm<T>(at.view(), bt.view(), ct.view());
+            }
+        }
+    }
+}
+
+template<typename T>
+requires std::is_floating_point_v<T>
+class TiledLU final
+{
+    using value_type = T;
+    using size_type = std::size_t;
+    using Tile = typename OutOfCoreMatrix<value_type>::Tile;
+
+    static constexpr size_type minParallelWork = 1U << 14U;
+
+    OutOfCoreMatrix<value_type>& a_;
+    std::vector<size_type> pivots_;
+    bool singular_ = false;
+
+    size_type first(size_type t) const {
+        return t * a_.tileSize();
+    }
+
+    size_type last(size_type t) const {
+        return std::min(a_.rows(), (t + 1U) * a_.tileSize());
+    }
+
+    void applyPivots(size_type k, size_type j) {
+        size_type ts = a_.tileSize();
+        for (size_type g = first(k); g < last(k); ++g) {
+            size_type p = pivots_[g];
+            if (p == g) {
+                continue;
+            }
+            Tile tg = a_.tile(g / ts, j, true);
+            Tile tp = a_.tile(p / ts, j, true);
+            std::swap_ranges(&tg.view()(g % ts, 0), &tg.view()(g % ts, 0) + tg.view().cols(), &tp.view()(p % ts, 0));
+        }
+    }
+
+    //b <- L^-1 b, L is the unit lower triangle of l.
+    static void solveUnitLower(ConstMatrixView<value_type> l, MatrixView<value_type> b) {
+        for (size_type i = 1; i < b.rows(); ++i) {
+            value_type* rowI = &b(i, 0);
+            for (size_type p = 0; p < i; ++p) {
+                const value_type coef = l(i, p);
+                const value_type* rowP = &b(p, 0);
+                for (size_type j = 0; j < b.cols(); ++j) {
+                    rowI[j] -= coef * rowP[j];
+                }
+            }
+        }
+    }
+
+    void updateColumn(size_type k, size_type j) {
+        size_type nt = a_.tileRows();
+        Matrix<value_type> negU;
+        {
+            Tile lkk = a_.tile(k, k);
+            Tile ukj = a_.tile(k, j, true);
+            solveUnitLower(lkk.view(), ukj.view());
+            negU = Matrix<value_type>{ukj.view()};
+            negU*=value_type{-1};
+        }
+        for (size_type i = k + 1U; i < nt; ++i) {
+            if (i + 1U < nt) {
+                a_.prefetch(i + 1U, k);
+                a_.prefetch(i + 1U, j);
+            }
+            Tile lik = a_.tile(i, k);
+            Tile aij = a_.tile(i, j, true);
+            gemm<value_type>(lik.view(), negU.view(), aij.view());
+        }
+    }
+
+    void factorPanel(size_type j) {
+        size_type n = a_.rows();
+        size_type ts = a_.tileSize();
+        std::vector<Tile> panel;
+        for (size_type i = j; i < a_.tileRows(); ++i) {
+            panel.push_back(a_.tile(i, j, true));
+        }
+        size_type w = panel.front().view().cols();
+        auto row = [&] (size_type g) {
+            return &panel[g / ts - j].view()(g % ts, 0);
+        };
+        for (size_type c = 0; c < w; ++c) {
+            size_type g = first(j) + c;
+            size_type p = g;
+            for (size_type r = g + 1U; r < n; ++r) {
+                if (std::abs(row(r)[c]) > std::abs(row(p)[c])) {
+                    p = r;
+                }
+            }
+            pivots_[g] = p;
+            if (p != g) {
+                std::swap_ranges(row(g), row(g) + w, row(p));
+            }
+            if (row(g)[c] == value_type{0}) {
+                singular_ = true;
+                continue;
+            }
+            const value_type inv = value_type{1} / row(g)[c];
+            const value_type* rowG = row(g);
+            size_type minChunk = std::max<size_type>(1U, minParallelWork / w);
+            ThreadPool::instance().parallelFor(g + 1U, n, [&] (size_type from, size_type to) {
+                for (size_type r = from; r < to; ++r) {
+                    value_type* rowR = row(r);
+                    value_type coef = rowR[c] * inv;
+                    rowR[c] = coef;
+                    for (size_type cc = c + 1U; cc < w; ++cc) {
+                        rowR[cc] -= coef * rowG[cc];
+                    }
+                }
+            }, minChunk);
+        }
+    }
+
+    void factorize() {
+        size_type nt = a_.tileRows();
+        if (a_.cacheTiles() < nt + 3U) {
+            throw std::logic_error("TiledLU: cache must hold a tile column and three more tiles");
+        }
+        for (size_type j = 0; j < nt; ++j) {
+            for (size_type k = 0; k < j; ++k) {
+                applyPivots(k, j);
+                updateColumn(k, j);
+            }
+            factorPanel(j);
+        }
+        a_.flush();
+    }
+
+public:
+    explicit TiledLU(OutOfCoreMatrix<value_type>& a):
+        a_(a), pivots_(a.rows()) {
+        if (a.rows() != a.cols()) {
+            throw std::logic_error("LU: matrix isn't square");
+        }
+        factorize();
+    }
+
+    size_type size() const {
+        return a_.rows();
+    }
+
+    bool singular() const {
+        return singular_;
+    }
+
+    const std::vector<size_type>& pivots() const {
+        return pivots_;
+    }
+
+    value_type det() {
+        value_type det{1};
+        for (size_type g = 0; g < size(); ++g) {
+            if (pivots_[g] != g) {
+                det = -det;
+            }
+        }
+        for (size_type k = 0; k < a_.tileRows(); ++k) {
+            Tile tkk = a_.tile(k, k);
+            for (size_type i = 0; i < tkk.view().rows(); ++i) {
+                det *= tkk.view()(i, i);
+            }
+        }
+        return det;
+    }
+
+    std::vector<value_type> solve(std::vector<value_type> b) {
+        if (b.size() != size()) {
+            throw std::logic_error("Solve: sizes don't match");
+        }
+        if (singular_) {
+            throw std::runtime_error("Solve: matrix is singular");
+        }
+        size_type nt = a_.tileRows();
+        for (size_type k = 0; k < nt; ++k) {
+            for (size_type g = first(k); g < last(k); ++g) {
+                std::swap(b[g], b[pivots_[g]]);
+            }
+            Tile lkk = a_.tile(k, k);
+            auto l = lkk.view();
+            for (size_type i = 0; i < l.rows(); ++i) {
+                for (size_type p = 0; p < i; ++p) {
+                    b[first(k) + i] -= l(i, p) * b[first(k) + p];
+                }
+            }
+            for (size_type i = k + 1U; i < nt; ++i) {
+                Tile lik = a_.tile(i, k);
+                auto li = lik.view();
+                for (size_type r = 0; r < li.rows(); ++r) {
+                    value_type sum{0};
+                    for (size_type p = 0; p < li.cols(); ++p) {
+                        sum += li(r, p) * b[first(k) + p];
+                    }
+                    b[first(i) + r] -= sum;
+                }
+            }
+        }
+        for (size_type k = nt; k-- > 0;) {
+            for (size_type j = k + 1U; j < nt; ++j) {
+                Tile ukj = a_.tile(k, j);
+                auto u = ukj.view();
+                for (size_type r = 0; r < u.rows(); ++r) {
+                    value_type sum{0};
+                    for (size_type p = 0; p < u.cols(); ++p) {
+                        sum += u(r, p) * b[first(j) + p];
+                    }
+                    b[first(k) + r] -= sum;
+                }
+            }
+            Tile ukk = a_.tile(k, k);
+            auto u = ukk.view();
+            for (size_type i = u.rows(); i-- > 0;) {
+                value_type sum = b[first(k) + i];
+                for (size_type p = i + 1U; p < u.cols(); ++p) {
+                    sum -= u(i, p) * b[first(k) + p];
+                }
+                b[first(k) + i] = sum / u(i, i);
+            }
+        }
+        return b;
+    }
+};
+
+} //namespace matrix
@@ -0,0 +1,230 @@
+#pragma once
+
+/*
+Class ProductChain. Lazy product of matrices: chain(a) * b * c * d only collects views
+of the operands; the product is computed by eval() or on conversion to Matrix.
+At evaluation the classic O(k^3) dynamic programming over the dimensions picks the
+association with the fewest scalar multiplications, and the products run through
+gemm (Strassen for big squares on a single thread, see useStrassen). Intermediate
+results live in a pool of buffers: a buffer is returned to the pool as soon as its
+product has been consumed, and the next intermediate of no bigger size reuses it.
+Operands are not copied, so they must outlive the evaluation: temporary matrices are
+rejected at compile time.
+Functionality:
+    size_type size()           - number of operands
+    size_type cost()           - scalar multiplications of the optimal order
+    std::string order()        - optimal parenthesization, e.g. "((A0 A1) A2)"
+    Matrix eval(), operator Matrix()
+    operator*=(view), operator*(chain, matrix), operator*(chain, chain)
+
+Function chain(mtx). Starts a chain.
+*/
+
+#include <string>
+#include <vector>
+#include <limits>
+#include "Matrix.hpp"
+#include "Gemm.hpp"
+#include "Strassen.hpp"
+
+namespace matrix {
+
+template<typename T>
+class ProductChain final
+{
+    using value_type = T;
+    using size_type = std::size_t;
+
+    std::vector<ConstMatrixView<value_type>> operands_;
+
+    struct Plan
+    {
+        size_type k = 0U;
+        std::vector<size_type> cost;
+        std::vector<size_type> split;
+
+        size_type& at(std::vector<size_type>& table, size_type i, size_type j) const {
+            return table[i * k + j];
+        }
+    };
+
+    Plan plan() const {
+        size_type k = operands_.size();
+        Plan res{k, std::vector<size_type>(k * k), std::vector<size_type>(k * k)};
+        std::vector<size_type> dims(k + 1U);
+        for (size_type i = 0; i < k; ++i) {
+            dims[i] = operands_[i].rows();
+        }
+        dims[k] = operands_.back().cols();
+        for (size_type len = 2; len <= k; ++len) {
+            for (size_type i = 0; i + len <= k; ++i) {
+                size_type j = i + len - 1U;
+                size_type best = std::numeric_limits<size_type>::max();
+                for (size_type s = i; s < j; ++s) {
+                    size_type cost = res.at(res.cost, i, s) + res.at(res.cost, s + 1U, j) +
+                                     dims[i] * dims[s + 1U] * dims[j + 1U];
+                    if (cost < best) {
+                        best = cost;
+                        res.at(res.split, i, j) = s;
+                    }
+                }
+                res.at(res.cost, i, j) = best;
+            }
+        }
+        return res;
+    }
+
+    std::string order(Plan& plan, size_type i, size_type j) const {
+        if (i == j) {
+            return "A" + std::to_string(i);
+        }
+        size_type s = plan.at(plan.split, i, j);
+        return "(" + order(plan, i, s) + " " + order(plan, s + 1U, j) + ")";
+    }
+
+    class BufferPool
+    {
+        std::vector<Storage<value_type>> free_;
+
+    public:
+        Storage<value_type> take(size_type size) {
+            for (auto it = free_.begin(); it != free_.end(); ++it) {
+                if (it->size() >= size) {
+                    Storage<value_type> res{std::move(*it)};
+                    free_.erase(it);
+                    return res;
+                }
+            }
+            return Storage<value_type>{size, uninitialized};
+        }
+
+        void give(Storage<value_type>&& buffer) {
+            free_.push_back(std::move(buffer));
+        }
+    };
+
+    struct Product
+    {
+        ConstMatrixView<value_type> view;
+        Storage<value_type> buffer;
+    };
+
+    static void multiply(ConstMatrixView<value_type> lhs, ConstMatrixView<value_type> rhs, MatrixView<value_type> dst) {
+        if (useStrassen(lhs, rhs)) {
+            strassen<value_type>(lhs, rhs, dst);
+            return;
+        }
+        dst.fill(value_type{});
+        gemm<value_type>(lhs, rhs, dst);
+    }
+
+    Product evaluate(Plan& plan, BufferPool& pool, size_type i, size_type j) const {
+        if (i == j) {
+            return Product{operands_[i], Storage<value_type>{}};
+        }
+        size_type s = plan.at(plan.split, i, j);
+        Product lhs = evaluate(plan, pool, i, s);
+        Product rhs = evaluate(plan, pool, s + 1U, j);
+        size_type m = lhs.view.rows();
+        size_type n = rhs.view.cols();
+        Product res{ConstMatrixView<value_type>{}, pool.take(m * n)};
+        MatrixView<value_type> dst{res.buffer.data(), m, n, n};
+        multiply(lhs.view, rhs.view, dst);
+        res.view = dst;
+        if (!lhs.buffer.empty()) {
+            pool.give(std::move(lhs.buffer));
+        }
+        if (!rhs.buffer.empty()) {
+            pool.give(std::move(rhs.buffer));
+        }
+        return res;
+    }
+
+public:
+    ProductChain() = default;
+
+    explicit ProductChain(ConstMatrixView<value_type> mtx):
+        operands_{mtx} {}
+
+    size_type size() const {
+        return operands_.size();
+    }
+
+    ProductChain& operator*=(ConstMatrixView<value_type> rhs) {
+        if (!operands_.empty() && operands_.back().cols() != rhs.rows()) {
+            throw std::logic_error("Operator *=: sizes don't match");
+        }
+        operands_.push_back(rhs);
+        return *this;
+    }
+
+    ProductChain& operator*=(const ProductChain& rhs) {
+        for (const auto& operand: rhs.operands_) {
+            *this *= operand;
+        }
+        return *this;
+    }
+
+    size_type cost() const {
+        if (operands_.empty()) {
+            return 0U;
+        }
+        Plan res = plan();
+        return res.at(res.cost, 0, size() - 1U);
+    }
+
+    std::string order() const {
+        if (operands_.empty()) {
+            return "";
+        }
+        Plan res = plan();
+        return order(res, 0, size() - 1U);
+    }
+
+    Matrix<value_type> eval() const {
+        if (operands_.empty()) {
+            throw std::logic_error("ProductChain: chain is empty");
+        }
+        if (size() == 1U) {
+            return Matrix<value_type>{operands_.front()};
+        }
+        Plan res = plan();
+        BufferPool pool;
+        size_type s = res.at(res.split, 0, size() - 1U);
+        Product lhs = evaluate(res, pool, 0, s);
+        Product rhs = evaluate(res, pool, s + 1U, size() - 1U);
+        Matrix<value_type> product{lhs.view.rows(), rhs.view.cols(), uninitialized};
+        multiply(lhs.view, rhs.view, product.view());
+        return product;
+    }
+
+    operator Matrix<value_type>() const {
+        return eval();
+    }
+};
+
+template<typename T, typename A>
+ProductChain<T> chain(const Matrix<T, A>& mtx) {
+    return ProductChain<T>{mtx.view()};
+}
+
+template<typename T, typename A>
+ProductChain<T> operator*(ProductChain<T> lhs, const Matrix<T, A>& rhs) {
+    lhs*=rhs.view();
+    return lhs;
+}
+
+//A temporary would be destroyed before the chain is evaluated.
+template<typename T, typename A>
+ProductChain<T> chain(Matrix<T, A>&& mtx) = delete;
+
+template<typename T, typename A>
+ProductChain<T> operator*(ProductChain<T> lhs, Matrix<T, A>&& rhs) = delete;
+
+template<typename T>
+ProductChain<T> operator*(ProductChain<T> lhs, const ProductChain<T>& rhs) {
+    lhs*=rhs;
+    return lhs;
+}
+
+} //namespace matrix
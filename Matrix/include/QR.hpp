@@ -0,0 +1,274 @@
+#pragma once
+
+/*
+Class QR<T>. Householder QR decomposition A = QR of an m x n matrix, blocked with the
+compact WY representation as in LAPACK geqrf: qrPanel columns are factorized with
+single reflectors, which are then gathered into Q_panel = I - V T V^T with T upper
+triangular, and the rest of the matrix gets Q_panel^T applied by two gemm calls,
+    W = V^T C,  C -= V (T^T W).
+The matrix is taken by value and factorized in its own storage: R is on and above the
+diagonal, reflectors v (with implicit v[j] = 1) below it. Functionality:
+    QR(mtx)
+    size_type rows(), cols()
+    bool fullRank()            - no zero on the diagonal of R
+    Matrix<T> r()              - min(m, n) x n upper triangle
+    Matrix<T> q()              - m x min(m, n) with orthonormal columns
+    std::vector<T> applyQt(b)  - Q^T b, m elements
+    std::vector<T> solve(b)    - least squares min |Ax - b| for m >= n, throws
+                                 std::runtime_error if A isn't of full rank
+    const Matrix<T>& factors(), const std::vector<T>& taus()
+*/
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "Matrix.hpp"
+#include "Gemm.hpp"
+#include "ThreadPool.hpp"
+
+namespace matrix {
+
+inline constexpr std::size_t qrPanel = 32U;
+
+template<typename T>
+requires std::is_floating_point_v<T>
+class QR final
+{
+    using value_type = T;
+    using size_type = std::size_t;
+
+    Matrix<value_type> qr_;
+    std::vector<value_type> taus_;
+    std::vector<Matrix<value_type>> blocks_; //T factor of every panel
+
+    size_type steps() const {
+        return std::min(rows(), cols());
+    }
+
+    void factorPanel(size_type j0, size_type nb) {
+        size_type m = rows();
+        auto a = qr_.view();
+        std::vector<value_type> s(nb);
+        for (size_type j = j0; j < j0 + nb; ++j) {
+            value_type alpha = a(j, j);
+            value_type sigma{0};
+            for (size_type i = j + 1; i < m; ++i) {
+                sigma += a(i, j) * a(i, j);
+            }
+            value_type tau{0};
+            if (sigma != value_type{0}) {
+                value_type norm = std::sqrt(alpha * alpha + sigma);
+                value_type beta = alpha <= value_type{0} ? norm : -norm;
+                tau = (beta - alpha) / beta;
+                value_type scale = value_type{1} / (alpha - beta);
+                for (size_type i = j + 1; i < m; ++i) {
+                    a(i, j) *= scale;
+                }
+                a(j, j) = beta;
+            }
+            taus_[j] = tau;
+            if (tau == value_type{0}) {
+                continue;
+            }
+            //The rest of the panel: c -= tau v (v^T c), rows are walked contiguously.
+            size_type first = j + 1;
+            size_type last = j0 + nb;
+            for (size_type c = first; c < last; ++c) {
+                s[c - j0] = a(j, c);
+            }
+            for (size_type i = j + 1; i < m; ++i) {
+                const value_type* row = &a(i, 0);
+                for (size_type c = first; c < last; ++c) {
+                    s[c - j0] += row[j] * row[c];
+                }
+            }
+            for (size_type c = first; c < last; ++c) {
+                s[c - j0] *= tau;
+                a(j, c) -= s[c - j0];
+            }
+            for (size_type i = j + 1; i < m; ++i) {
+                value_type* row = &a(i, 0);
+                for (size_type c = first; c < last; ++c) {
+                    row[c] -= s[c - j0] * row[j];
+                }
+            }
+        }
+    }
+
+    //V^T of the panel as a dense nb x (m - j0) matrix, unit diagonal and zeros above made explicit.
+    Matrix<value_type> panelVt(size_type j0, size_type nb) const {
+        size_type mm = rows() - j0;
+        Matrix<value_type> vt{nb, mm};
+        for (size_type t = 0; t < nb; ++t) {
+            vt[t][t] = value_type{1};
+        }
+        for (size_type r = 1; r < mm; ++r) {
+            for (size_type t = 0; t < std::min(r, nb); ++t) {
+                vt[t][r] = qr_[j0 + r][j0 + t];
+            }
+        }
+        return vt;
+    }
+
+    //T(0:i, i) = -tau_i T(0:i, 0:i) V(:, 0:i)^T v_i, as in LAPACK larft.
+    Matrix<value_type> panelT(const Matrix<value_type>& vt, size_type j0) const {
+        size_type nb = vt.rows();
+        size_type mm = vt.cols();
+        Matrix<value_type> tf{nb, nb};
+        std::vector<value_type> z(nb);
+        for (size_type i = 0; i < nb; ++i) {
+            value_type tau = taus_[j0 + i];
+            tf[i][i] = tau;
+            for (size_type t = 0; t < i; ++t) {
+                value_type sum{0};
+                for (size_type r = i; r < mm; ++r) {
+                    sum += vt[t][r] * vt[i][r];
+                }
+                z[t] = sum;
+            }
+            for (size_type t = 0; t < i; ++t) {
+                value_type sum{0};
+                for (size_type p = t; p < i; ++p) {
+                    sum += tf[t][p] * z[p];
+                }
+                tf[t][i] = -tau * sum;
+            }
+        }
+        return tf;
+    }
+
+    //c <- (I - V T V^T)^T c if transpose, else (I - V T V^T) c; c has the rows j0.. of the target.
+    static void applyBlock(const Matrix<value_type>& vt, const Matrix<value_type>& tf, MatrixView<value_type> c,
+                           bool transpose) {
+        size_type nb = vt.rows();
+        size_type mm = vt.cols();
+        size_type n = c.cols();
+        if (n == 0U) {
+            return;
+        }
+        Matrix<value_type> w{nb, n};
+        gemm<value_type>(vt.view(), c, w.view());
+        Matrix<value_type> tw{nb, n}; //-op(T) W, so that the second gemm subtracts
+        ThreadPool::instance().parallelFor(0, nb, [&] (size_type first, size_type last) {
+            for (size_type i = first; i < last; ++i) {
+                for (size_type p = 0; p < nb; ++p) {
+                    value_type coef = transpose ? tf[p][i] : tf[i][p];
+                    if (coef == value_type{0}) {
+                        continue;
+                    }
+                    const value_type* src = &w[p][0];
+                    value_type* dst = &tw[i][0];
+                    for (size_type j = 0; j < n; ++j) {
+                        dst[j] -= coef * src[j];
+                    }
+                }
+            }
+        });
+        Matrix<value_type> v{mm, nb, uninitialized};
+        for (size_type r = 0; r < mm; ++r) {
+            for (size_type t = 0; t < nb; ++t) {
+                v[r][t] = vt[t][r];
+            }
+        }
+        gemm<value_type>(v.view(), tw.view(), c);
+    }
+
+    void factorize() {
+        size_type m = rows();
+        size_type n = cols();
+        for (size_type j0 = 0; j0 < steps(); j0 += qrPanel) {
+            size_type nb = std::min(qrPanel, steps() - j0);
+            factorPanel(j0, nb);
+            Matrix<value_type> vt = panelVt(j0, nb);
+            blocks_.push_back(panelT(vt, j0));
+            if (j0 + nb < n) {
+                applyBlock(vt, blocks_.back(), qr_.view().block(j0, j0 + nb, m - j0, n - j0 - nb), true);
+            }
+        }
+    }
+
+public:
+    explicit QR(Matrix<value_type> a):
+        qr_(std::move(a)), taus_(std::min(qr_.rows(), qr_.cols())) {
+        factorize();
+    }
+
+    size_type rows() const {
+        return qr_.rows();
+    }
+
+    size_type cols() const {
+        return qr_.cols();
+    }
+
+    bool fullRank() const {
+        for (size_type i = 0; i < steps(); ++i) {
+            if (qr_[i][i] == value_type{0}) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Matrix<value_type> r() const {
+        Matrix<value_type> res{steps(), cols()};
+        for (size_type i = 0; i < steps(); ++i) {
+            std::copy(&qr_[i][0] + i, &qr_[i][0] + cols(), &res[i][0] + i);
+        }
+        return res;
+    }
+
+    Matrix<value_type> q() const {
+        Matrix<value_type> res{rows(), steps()};
+        for (size_type i = 0; i < steps(); ++i) {
+            res[i][i] = value_type{1};
+        }
+        for (size_type b = blocks_.size(); b-- > 0;) {
+            size_type j0 = b * qrPanel;
+            Matrix<value_type> vt = panelVt(j0, blocks_[b].rows());
+            applyBlock(vt, blocks_[b], res.view().block(j0, j0, rows() - j0, steps() - j0), false);
+        }
+        return res;
+    }
+
+    std::vector<value_type> applyQt(std::vector<value_type> b) const {
+        if (b.size() != rows()) {
+            throw std::logic_error("QR: sizes don't match");
+        }
+        for (size_type k = 0; k < blocks_.size(); ++k) {
+            size_type j0 = k * qrPanel;
+            Matrix<value_type> vt = panelVt(j0, blocks_[k].rows());
+            applyBlock(vt, blocks_[k], MatrixView<value_type>{b.data() + j0, rows() - j0, 1U, 1U}, true);
+        }
+        return b;
+    }
+
+    std::vector<value_type> solve(const std::vector<value_type>& b) const {
+        if (rows() < cols()) {
+            throw std::logic_error("Solve: system is underdetermined");
+        }
+        if (!fullRank()) {
+            throw std::runtime_error("Solve: matrix isn't of full rank");
+        }
+        std::vector<value_type> y = applyQt(b);
+        y.resize(cols());
+        for (size_type i = cols(); i-- > 0;) {
+            value_type sum = y[i];
+            for (size_type j = i + 1; j < cols(); ++j) {
+                sum -= qr_[i][j] * y[j];
+            }
+            y[i] = sum / qr_[i][i];
+        }
+        return y;
+    }
+
+    const Matrix<value_type>& factors() const {
+        return qr_;
+    }
+
+    const std::vector<value_type>& taus() const {
+        return taus_;
+    }
+};
+
+} //namespace matrix
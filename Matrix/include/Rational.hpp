@@ -0,0 +1,166 @@
+#pragma once
+
+/*
+Class Rational. Exact fraction num / den of long long, always reduced, den > 0.
+Intermediate products are computed in 128 bits, reduced by gcd and only then narrowed:
+throws std::overflow_error if the reduced result doesn't fit in long long.
+Functionality:
+    Rational(integer), Rational(num, den) - throws std::domain_error if den is zero
+    long long numerator(), denominator()
+    operators + - * / (throws std::domain_error on division by zero), unary -
+    operators == and <=>
+    explicit operator double()
+
+isZero and equals are exact.
+*/
+
+#include <limits>
+#include <compare>
+#include <iostream>
+#include <stdexcept>
+#include "Modular.hpp"
+
+namespace matrix {
+
+class Rational final
+{
+    long long num_ = 0;
+    long long den_ = 1;
+
+    static i128 gcd(i128 lhs, i128 rhs) {
+        lhs = lhs < 0 ? -lhs : lhs;
+        rhs = rhs < 0 ? -rhs : rhs;
+        while (rhs != 0) {
+            i128 rem = lhs % rhs;
+            lhs = rhs;
+            rhs = rem;
+        }
+        return lhs;
+    }
+
+    static long long narrow(i128 value) {
+        if (value > std::numeric_limits<long long>::max() || value < std::numeric_limits<long long>::min()) {
+            throw std::overflow_error("Rational: value doesn't fit in long long");
+        }
+        return static_cast<long long>(value);
+    }
+
+    void assign(i128 num, i128 den) {
+        if (den == 0) {
+            throw std::domain_error("Rational: division by zero");
+        }
+        if (den < 0) {
+            num = -num;
+            den = -den;
+        }
+        i128 g = gcd(num, den);
+        if (g > 1) {
+            num /= g;
+            den /= g;
+        }
+        num_ = narrow(num);
+        den_ = narrow(den);
+    }
+
+public:
+    Rational() = default;
+
+    Rational(long long value):
+        num_(value) {}
+
+    Rational(long long num, long long den) {
+        assign(num, den);
+    }
+
+    long long numerator() const {
+        return num_;
+    }
+
+    long long denominator() const {
+        return den_;
+    }
+
+    Rational& operator+=(const Rational& rhs) {
+        assign(static_cast<i128>(num_) * rhs.den_ + static_cast<i128>(rhs.num_) * den_,
+               static_cast<i128>(den_) * rhs.den_);
+        return *this;
+    }
+
+    Rational& operator-=(const Rational& rhs) {
+        assign(static_cast<i128>(num_) * rhs.den_ - static_cast<i128>(rhs.num_) * den_,
+               static_cast<i128>(den_) * rhs.den_);
+        return *this;
+    }
+
+    Rational& operator*=(const Rational& rhs) {
+        assign(static_cast<i128>(num_) * rhs.num_, static_cast<i128>(den_) * rhs.den_);
+        return *this;
+    }
+
+    Rational& operator/=(const Rational& rhs) {
+        assign(static_cast<i128>(num_) * rhs.den_, static_cast<i128>(den_) * rhs.num_);
+        return *this;
+    }
+
+    Rational operator-() const {
+        Rational res;
+        res.num_ = narrow(-static_cast<i128>(num_));
+        res.den_ = den_;
+        return res;
+    }
+
+    bool operator==(const Rational& rhs) const = default;
+
+    std::strong_ordering operator<=>(const Rational& rhs) const {
+        i128 lhs = static_cast<i128>(num_) * rhs.den_;
+        i128 other = static_cast<i128>(rhs.num_) * den_;
+        return lhs < other ? std::strong_ordering::less :
+               lhs > other ? std::strong_ordering::greater : std::strong_ordering::equal;
+    }
+
+    explicit operator double() const {
+        return static_cast<double>(num_) / static_cast<double>(den_);
+    }
+};
+
+inline Rational operator+(const Rational& lhs, const Rational& rhs) {
+    Rational res{lhs};
+    res+=rhs;
+    return res;
+}
+
+inline Rational operator-(const Rational& lhs, const Rational& rhs) {
+    Rational res{lhs};
+    res-=rhs;
+    return res;
+}
+
+inline Rational operator*(const Rational& lhs, const Rational& rhs) {
+    Rational res{lhs};
+    res*=rhs;
+    return res;
+}
+
+inline Rational operator/(const Rational& lhs, const Rational& rhs) {
+    Rational res{lhs};
+    res/=rhs;
+    return res;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const Rational& value) {
+    os << value.numerator();
+    if (value.denominator() != 1) {
+        os << '/' << value.denominator();
+    }
+    return os;
+}
+
+inline bool isZero(const Rational& value) {
+    return value.numerator() == 0;
+}
+
+inline bool equals(const Rational& lhs, const Rational& rhs) {
+    return lhs == rhs;
+}
+
+} //namespace matrix
@@ -0,0 +1,129 @@
+#pragma once
+
+/*
+Linear solve Ax = b.
+
+Function solveRefined(A, b). For double: A is factorized in float, which halves the
+memory traffic of the O(n^3) part, and the O(n^2) iterative refinement
+    r = b - Ax (double), Ad = r (float factors), x += d
+restores double accuracy. As in LAPACK dsgesv, x is accepted once
+|r| <= |x| |A| eps sqrt(n) (infinity norms); if that doesn't happen in maxRefinements
+steps, the system is solved again with a double factorization. Also falls back when
+the float factorization is singular or overflows. Other floating point types are
+factorized once in their own precision.
+Returns SolveResult: x, number of refinement steps, and whether float factors sufficed.
+
+Function solve(A, b). Returns x only.
+*/
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "LU.hpp"
+
+namespace matrix {
+
+inline constexpr std::size_t maxRefinements = 30U;
+
+template<typename T>
+struct SolveResult
+{
+    std::vector<T> x;
+    std::size_t iterations = 0U;
+    bool mixed = false;
+};
+
+namespace detail {
+
+template<typename T>
+T normInf(const std::vector<T>& v) {
+    T norm = T{0};
+    for (const T& value: v) {
+        norm = std::max(norm, std::abs(value));
+    }
+    return norm;
+}
+
+template<typename T>
+std::vector<T> rowSums(ConstMatrixView<T> a) {
+    std::vector<T> sums(a.rows());
+    for (std::size_t i = 0; i < a.rows(); ++i) {
+        for (std::size_t j = 0; j < a.cols(); ++j) {
+            sums[i] += std::abs(a(i, j));
+        }
+    }
+    return sums;
+}
+
+template<typename T>
+std::vector<T> residual(ConstMatrixView<T> a, const std::vector<T>& b, const std::vector<T>& x) {
+    std::vector<T> r(b.size());
+    ThreadPool::instance().parallelFor(0, a.rows(), [&] (std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            const T* row = &a(i, 0);
+            T sum = T{0};
+            for (std::size_t j = 0; j < a.cols(); ++j) {
+                sum += row[j] * x[j];
+            }
+            r[i] = b[i] - sum;
+        }
+    }, 64U);
+    return r;
+}
+
+} //namespace detail
+
+template<typename T>
+requires std::is_floating_point_v<T>
+SolveResult<T> solveRefined(ConstMatrixView<T> a, const std::vector<T>& b) {
+    if (!a.square()) {
+        throw std::logic_error("Solve: matrix isn't square");
+    }
+    if (a.rows() != b.size()) {
+        throw std::logic_error("Solve: sizes don't match");
+    }
+    if (a.colStride() != 1U) {
+        return SolveResult<T>{LU<T>{a}.solve(b)};
+    }
+    if constexpr (std::is_same_v<T, double>) {
+        LU<float> lowLU{a};
+        if (!lowLU.singular() && lowLU.finite()) {
+            std::vector<float> lowX = lowLU.solve(b);
+            std::vector<double> x(lowX.begin(), lowX.end());
+            double tolerance = detail::normInf(detail::rowSums(a)) * std::numeric_limits<double>::epsilon() *
+                               std::sqrt(static_cast<double>(a.rows()));
+            for (std::size_t iter = 0; iter <= maxRefinements; ++iter) {
+                std::vector<double> r = detail::residual(a, b, x);
+                double xNorm = detail::normInf(x);
+                if (!std::isfinite(xNorm)) {
+                    break;
+                }
+                if (detail::normInf(r) <= xNorm * tolerance) {
+                    return SolveResult<T>{std::move(x), iter, true};
+                }
+                std::vector<float> d = lowLU.solve(r);
+                for (std::size_t i = 0; i < x.size(); ++i) {
+                    x[i] += static_cast<double>(d[i]);
+                }
+            }
+        }
+    }
+    return SolveResult<T>{LU<T>{a}.solve(b)};
+}
+
+template<typename T, typename A>
+SolveResult<T> solveRefined(const Matrix<T, A>& a, const std::vector<T>& b) {
+    return solveRefined<T>(a.view(), b);
+}
+
+template<typename T>
+std::vector<T> solve(ConstMatrixView<T> a, const std::vector<T>& b) {
+    return solveRefined<T>(a, b).x;
+}
+
+template<typename T, typename A>
+std::vector<T> solve(const Matrix<T, A>& a, const std::vector<T>& b) {
+    return solveRefined<T>(a.view(), b).x;
+}
+
+} //namespace matrix
@@ -0,0 +1,476 @@
+#pragma once
+
+/*
+Struct Triplet. (row, col, value) element used to build sparse matrices.
+
+Class SparseMatrix. Matrix in CSR format: memory and time scale with the number
+of non-zero elements. Functionality:
+    SparseMatrix(m, n, triplets) - duplicates are summed, zeros are dropped
+    SparseMatrix(const Matrix&)
+    Matrix toDense()
+    static eye(), diag()
+    size_type rows()
+    size_type cols()
+    size_type nnz()
+    value_type at(i, j)
+    value_type det() - sparse LU, columns in natural order, threshold pivoting by row
+                       length: the shortest row with |a_ik| >= pivotThreshold * max |a_ik|.
+                       It isn't Markowitz: the column count of (r - 1)(c - 1) is not used
+    void transpose()
+    operator+=
+    operator-=
+    operator*=(value)
+    void dump()
+
+Free operators: SpMV (sparse * std::vector), SpMM (sparse * Matrix), +, -.
+*/
+
+#include <vector>
+#include <numeric>
+#include "Matrix.hpp"
+
+namespace matrix {
+
+template<typename T>
+struct Triplet
+{
+    std::size_t row = 0U;
+    std::size_t col = 0U;
+    T value = T{};
+};
+
+template<typename T>
+class SparseMatrix final
+{
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T &;
+    using const_reference = const T &;
+    using Entry = std::pair<size_type, value_type>;
+    using SparseRow = std::vector<Entry>;
+
+    size_type m_ = 0U;
+    size_type n_ = 0U;
+    std::vector<size_type> rowPtr_;
+    std::vector<size_type> colInd_;
+    std::vector<value_type> values_;
+
+    static bool nonZero(const value_type& value) {
+        return !(value == value_type{0});
+    }
+
+    template<typename Op>
+    SparseMatrix& merge(const SparseMatrix& rhs, Op op) {
+        SparseMatrix res{m_, n_};
+        res.colInd_.reserve(nnz() + rhs.nnz());
+        res.values_.reserve(nnz() + rhs.nnz());
+        for (size_type i = 0; i < m_; ++i) {
+            size_type p = rowPtr_[i];
+            size_type q = rhs.rowPtr_[i];
+            while (p < rowPtr_[i + 1] || q < rhs.rowPtr_[i + 1]) {
+                size_type col = 0U;
+                value_type value{};
+                if (q == rhs.rowPtr_[i + 1] || (p < rowPtr_[i + 1] && colInd_[p] < rhs.colInd_[q])) {
+                    col = colInd_[p];
+                    value = values_[p++];
+                } else if (p == rowPtr_[i + 1] || rhs.colInd_[q] < colInd_[p]) {
+                    col = rhs.colInd_[q];
+                    value = op(value_type{0}, rhs.values_[q++]);
+                } else {
+                    col = colInd_[p];
+                    value = op(values_[p++], rhs.values_[q++]);
+                }
+                if (nonZero(value)) {
+                    res.colInd_.push_back(col);
+                    res.values_.push_back(value);
+                }
+            }
+            res.rowPtr_[i + 1] = res.colInd_.size();
+        }
+        *this = std::move(res);
+        return *this;
+    }
+
+    //row -= coef * pivotRow. Both rows start at the pivot column, which is dropped
+    //instead of being computed, so round-off can't leave a residue there.
+    template<typename F>
+    static SparseRow eliminate(const SparseRow& row, const SparseRow& pivotRow, const value_type& coef, F onFill) {
+        SparseRow res;
+        res.reserve(row.size() + pivotRow.size());
+        auto p = std::next(row.begin());
+        auto q = std::next(pivotRow.begin());
+        while (p != row.end() || q != pivotRow.end()) {
+            if (q == pivotRow.end() || (p != row.end() && p->first < q->first)) {
+                res.push_back(*p++);
+                continue;
+            }
+            value_type value = -coef * q->second;
+            size_type col = q->first;
+            bool fill = true;
+            if (p != row.end() && p->first == q->first) {
+                value += p++->second;
+                fill = false;
+            }
+            ++q;
+            if (nonZero(value)) {
+                res.emplace_back(col, value);
+                if (fill) {
+                    onFill(col);
+                }
+            }
+        }
+        return res;
+    }
+
+    //Right-looking sparse LU. Column k is eliminated from every active row; the pivot
+    //is the shortest row among those whose |a_ik| is not much less than the column maximum.
+    value_type detLU() const requires std::is_floating_point_v<value_type> {
+        if (!square()) {
+            throw std::logic_error("Matrix isn't square");
+        }
+        if (empty()) {
+            throw std::logic_error("Matrix is empty");
+        }
+        std::vector<SparseRow> rows(m_);
+        std::vector<std::vector<size_type>> colRows(n_);
+        for (size_type i = 0; i < m_; ++i) {
+            for (size_type p = rowPtr_[i]; p < rowPtr_[i + 1]; ++p) {
+                rows[i].emplace_back(colInd_[p], values_[p]);
+                colRows[colInd_[p]].push_back(i);
+            }
+        }
+        std::vector<bool> active(m_, true);
+        std::vector<size_type> mark(m_, n_);
+        std::vector<size_type> perm(n_);
+        value_type detAbs = value_type{1};
+        for (size_type k = 0; k < n_; ++k) {
+            std::vector<size_type> candidates;
+            value_type maxAbs = value_type{0};
+            for (size_type i: colRows[k]) {
+                if (active[i] && mark[i] != k && !rows[i].empty() && rows[i].front().first == k) {
+                    mark[i] = k;
+                    candidates.push_back(i);
+                    maxAbs = std::max(maxAbs, std::abs(rows[i].front().second));
+                }
+            }
+            if (candidates.empty() || ::matrix::isZero(maxAbs)) {
+                return value_type{0};
+            }
+            size_type pivot = m_;
+            for (size_type i: candidates) {
+                if (std::abs(rows[i].front().second) >= pivotThreshold * maxAbs &&
+                    (pivot == m_ || rows[i].size() < rows[pivot].size())) {
+                    pivot = i;
+                }
+            }
+            active[pivot] = false;
+            perm[k] = pivot;
+            const SparseRow& pivotRow = rows[pivot];
+            value_type pivotValue = pivotRow.front().second;
+            detAbs *= pivotValue;
+            for (size_type i: candidates) {
+                if (i == pivot) {
+                    continue;
+                }
+                value_type coef = rows[i].front().second / pivotValue;
+                rows[i] = eliminate(rows[i], pivotRow, coef, [&colRows, i] (size_type col) {
+                    colRows[col].push_back(i);
+                });
+            }
+            std::vector<size_type>{}.swap(colRows[k]);
+            SparseRow{}.swap(rows[pivot]);
+        }
+        value_type sign = value_type{1};
+        std::vector<bool> visited(n_, false);
+        for (size_type k = 0; k < n_; ++k) {
+            if (visited[k]) {
+                continue;
+            }
+            size_type length = 0U;
+            for (size_type i = k; !visited[i]; i = perm[i]) {
+                visited[i] = true;
+                length++;
+            }
+            if (length % 2 == 0) {
+                sign = -sign;
+            }
+        }
+        return sign * detAbs;
+    }
+
+public:
+    static constexpr double pivotThreshold = 0.1;
+
+    SparseMatrix() = default;
+
+    SparseMatrix(size_type m, size_type n):
+        m_(m), n_(n), rowPtr_(m + 1, 0U) {}
+
+    SparseMatrix(size_type m, size_type n, std::vector<Triplet<value_type>> triplets):
+        SparseMatrix(m, n) {
+        for (const auto& triplet: triplets) {
+            if (triplet.row >= m_ || triplet.col >= n_) {
+                throw std::out_of_range("SparseMatrix: triplet is out of range");
+            }
+            rowPtr_[triplet.row + 1]++;
+        }
+        std::partial_sum(rowPtr_.begin(), rowPtr_.end(), rowPtr_.begin());
+        std::vector<size_type> order(triplets.size());
+        std::vector<size_type> next{rowPtr_.begin(), rowPtr_.end() - 1};
+        for (size_type t = 0; t < triplets.size(); ++t) {
+            order[next[triplets[t].row]++] = t;
+        }
+        colInd_.reserve(triplets.size());
+        values_.reserve(triplets.size());
+        size_type begin = 0U;
+        for (size_type i = 0; i < m_; ++i) {
+            auto first = order.begin() + begin;
+            auto last = order.begin() + rowPtr_[i + 1];
+            std::sort(first, last, [&triplets] (size_type lhs, size_type rhs) {
+                return triplets[lhs].col < triplets[rhs].col;
+            });
+            begin = rowPtr_[i + 1];
+            for (auto it = first; it != last;) {
+                size_type col = triplets[*it].col;
+                value_type value = triplets[*it++].value;
+                while (it != last && triplets[*it].col == col) {
+                    value += triplets[*it++].value;
+                }
+                if (nonZero(value)) {
+                    colInd_.push_back(col);
+                    values_.push_back(value);
+                }
+            }
+            rowPtr_[i + 1] = colInd_.size();
+        }
+    }
+
+    template<typename A>
+    explicit SparseMatrix(const Matrix<value_type, A>& mtx):
+        SparseMatrix(mtx.rows(), mtx.cols()) {
+        for (size_type i = 0; i < m_; ++i) {
+            auto row = mtx[i];
+            for (size_type j = 0; j < n_; ++j) {
+                if (nonZero(row.data()[j])) {
+                    colInd_.push_back(j);
+                    values_.push_back(row.data()[j]);
+                }
+            }
+            rowPtr_[i + 1] = colInd_.size();
+        }
+    }
+
+    static SparseMatrix eye(size_type size, const value_type& val) {
+        std::vector<Triplet<value_type>> triplets;
+        triplets.reserve(size);
+        for (size_type i = 0; i < size; ++i) {
+            triplets.push_back({i, i, val});
+        }
+        return SparseMatrix{size, size, std::move(triplets)};
+    }
+
+    static SparseMatrix diag(size_type size, std::initializer_list<value_type> lst) {
+        std::vector<Triplet<value_type>> triplets;
+        size_type i = 0;
+        for (const auto& elem: lst) {
+            if (i == size) {
+                break;
+            }
+            triplets.push_back({i, i, elem});
+            ++i;
+        }
+        return SparseMatrix{size, size, std::move(triplets)};
+    }
+
+    Matrix<value_type> toDense() const {
+        Matrix<value_type> res{m_, n_};
+        for (size_type i = 0; i < m_; ++i) {
+            auto row = res[i];
+            for (size_type p = rowPtr_[i]; p < rowPtr_[i + 1]; ++p) {
+                row.data()[colInd_[p]] = values_[p];
+            }
+        }
+        return res;
+    }
+
+    size_type rows() const {
+        return m_;
+    }
+
+    size_type cols() const {
+        return n_;
+    }
+
+    size_type nnz() const {
+        return values_.size();
+    }
+
+    bool square() const {
+        return m_ == n_;
+    }
+
+    bool empty() const {
+        return n_ == 0U || m_ == 0U;
+    }
+
+    const std::vector<size_type>& rowPtr() const {
+        return rowPtr_;
+    }
+
+    const std::vector<size_type>& colInd() const {
+        return colInd_;
+    }
+
+    const std::vector<value_type>& values() const {
+        return values_;
+    }
+
+    value_type at(size_type i, size_type j) const {
+        if (i >= m_ || j >= n_) {
+            throw std::out_of_range("At: index is out of range");
+        }
+        auto first = colInd_.begin() + rowPtr_[i];
+        auto last = colInd_.begin() + rowPtr_[i + 1];
+        auto it = std::lower_bound(first, last, j);
+        return (it != last && *it == j) ? values_[it - colInd_.begin()] : value_type{0};
+    }
+
+    bool operator==(const SparseMatrix& rhs) const {
+        if (m_ != rhs.m_ || n_ != rhs.n_ || rowPtr_ != rhs.rowPtr_ || colInd_ != rhs.colInd_) {
+            return false;
+        }
+        for (size_type p = 0; p < values_.size(); ++p) {
+            if (!::matrix::equals(values_[p], rhs.values_[p])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool operator!=(const SparseMatrix& rhs) const {
+        return !(*this == rhs);
+    }
+
+    value_type det() const requires std::is_floating_point_v<value_type> {
+        return detLU();
+    }
+
+    SparseMatrix& transpose() {
+        SparseMatrix transposed{n_, m_};
+        for (size_type col: colInd_) {
+            transposed.rowPtr_[col + 1]++;
+        }
+        std::partial_sum(transposed.rowPtr_.begin(), transposed.rowPtr_.end(), transposed.rowPtr_.begin());
+        transposed.colInd_.resize(nnz());
+        transposed.values_.resize(nnz());
+        std::vector<size_type> next{transposed.rowPtr_.begin(), transposed.rowPtr_.end() - 1};
+        for (size_type i = 0; i < m_; ++i) {
+            for (size_type p = rowPtr_[i]; p < rowPtr_[i + 1]; ++p) {
+                size_type q = next[colInd_[p]]++;
+                transposed.colInd_[q] = i;
+                transposed.values_[q] = std::move(values_[p]);
+            }
+        }
+        *this = std::move(transposed);
+        return *this;
+    }
+
+    SparseMatrix& operator+=(const SparseMatrix& rhs) {
+        if (m_ != rhs.m_ || n_ != rhs.n_) {
+            throw std::logic_error("Operator +=: sizes don't match");
+        }
+        return merge(rhs, [] (const value_type& lhs, const value_type& rhs) { return lhs + rhs; });
+    }
+
+    SparseMatrix& operator-=(const SparseMatrix& rhs) {
+        if (m_ != rhs.m_ || n_ != rhs.n_) {
+            throw std::logic_error("Operator -=: sizes don't match");
+        }
+        return merge(rhs, [] (const value_type& lhs, const value_type& rhs) { return lhs - rhs; });
+    }
+
+    SparseMatrix& operator*=(const value_type& rhs) {
+        for (auto& value: values_) {
+            value *= rhs;
+        }
+        return *this;
+    }
+
+    std::vector<value_type> multiply(const std::vector<value_type>& x) const {
+        if (x.size() != n_) {
+            throw std::logic_error("Operator *: sizes don't match");
+        }
+        std::vector<value_type> y(m_);
+        for (size_type i = 0; i < m_; ++i) {
+            value_type sum{};
+            for (size_type p = rowPtr_[i]; p < rowPtr_[i + 1]; ++p) {
+                sum += values_[p] * x[colInd_[p]];
+            }
+            y[i] = sum;
+        }
+        return y;
+    }
+
+    template<typename A>
+    Matrix<value_type, A> multiply(const Matrix<value_type, A>& rhs) const {
+        if (n_ != rhs.rows()) {
+            throw std::logic_error("Operator *: sizes don't match");
+        }
+        size_type n = rhs.cols();
+        Matrix<value_type, A> res{m_, n};
+        for (size_type i = 0; i < m_; ++i) {
+            value_type* dst = res[i].data();
+            for (size_type p = rowPtr_[i]; p < rowPtr_[i + 1]; ++p) {
+                const value_type* src = rhs[colInd_[p]].data();
+                const value_type value = values_[p];
+                for (size_type j = 0; j < n; ++j) {
+                    dst[j] += value * src[j];
+                }
+            }
+        }
+        return res;
+    }
+
+    void dump(std::ostream& os) const {
+        os << "M " << m_ << "; N " << n_ << "; NNZ " << nnz() << "\n";
+        for (size_type i = 0; i < m_; ++i) {
+            for (size_type p = rowPtr_[i]; p < rowPtr_[i + 1]; ++p) {
+                os << "(" << i << ", " << colInd_[p] << ") " << values_[p] << "\n";
+            }
+        }
+        os.flush();
+    }
+};
+
+template<typename T>
+std::ostream& operator<<(std::ostream& os, const SparseMatrix<T>& mtx)
+{
+    mtx.dump(os);
+    return os;
+}
+
+template<typename T>
+std::vector<T> operator*(const SparseMatrix<T>& lhs, const std::vector<T>& rhs) {
+    return lhs.multiply(rhs);
+}
+
+template<typename T, typename A>
+Matrix<T, A> operator*(const SparseMatrix<T>& lhs, const Matrix<T, A>& rhs) {
+    return lhs.multiply(rhs);
+}
+
+template<typename T>
+SparseMatrix<T> operator+(const SparseMatrix<T>& lhs, const SparseMatrix<T>& rhs) {
+    SparseMatrix<T> res{lhs};
+    res+=rhs;
+    return res;
+}
+
+template<typename T>
+SparseMatrix<T> operator-(const SparseMatrix<T>& lhs, const SparseMatrix<T>& rhs) {
+    SparseMatrix<T> res{lhs};
+    res-=rhs;
+    return res;
+}
+
+} //namespace matrix
@@ -0,0 +1,198 @@
+#pragma once
+
+/*
+Strassen-Winograd multiplication of square matrices.
+
+Class Arena. Preallocated workspace: the whole recursion takes its temporaries from
+one buffer, sized by strassenWorkspace(n), so no level allocates.
+
+Function strassen(a, b, c[, arena], cutoff). c = a * b. Each level does 7 half-size
+products and 15 additions (Winograd's variant) in the order of Douglas et al., which
+needs only two half-size temporaries per level, 2/3 n^2 elements in total. Odd sizes
+are peeled: the last row and column are done by gemm. Blocks of size <= cutoff are
+multiplied by the blocked gemm.
+
+Function useStrassen(lhs, rhs). Whether a product should go through strassen: both are
+square, n >= strassenThreshold and the ThreadPool has a single thread. The recursion is
+serial and its 128-block leaves are too small for gemm to fork, so with more threads
+the parallel gemm wins; strassenThreshold was measured on one core by strassen_bench
+(test/StrassenBench.cpp). Matrix::operator*=, pow and ProductChain ask it.
+*/
+
+#include <memory>
+#include <algorithm>
+#include "Allocator.hpp"
+#include "MatrixView.hpp"
+#include "Gemm.hpp"
+#include "ThreadPool.hpp"
+
+namespace matrix {
+
+inline constexpr std::size_t strassenCutoff = 128U;
+inline constexpr std::size_t strassenThreshold = 4096U;
+
+inline std::size_t strassenWorkspace(std::size_t n, std::size_t cutoff = strassenCutoff) {
+    std::size_t total = 0U;
+    cutoff = std::max<std::size_t>(cutoff, 1U);
+    while (n > cutoff) {
+        n -= n % 2U;
+        n /= 2U;
+        total += 2U * n * n;
+    }
+    return total;
+}
+
+template<typename T>
+class Arena final
+{
+    using value_type = T;
+    using size_type = std::size_t;
+    using pointer = T *;
+
+    AlignedAllocator<value_type> alloc_;
+    pointer data_ = nullptr;
+    size_type size_ = 0U;
+
+    void release() {
+        if (data_ != nullptr) {
+            std::destroy_n(data_, size_);
+            alloc_.deallocate(data_, size_);
+            data_ = nullptr;
+            size_ = 0U;
+        }
+    }
+
+public:
+    Arena() = default;
+
+    explicit Arena(size_type size) {
+        reserve(size);
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+        release();
+    }
+
+    void reserve(size_type size) {
+        if (size <= size_) {
+            return;
+        }
+        release();
+        data_ = alloc_.allocate(size);
+        std::uninitialized_default_construct_n(data_, size);
+        size_ = size;
+    }
+
+    pointer data() const {
+        return data_;
+    }
+
+    size_type size() const {
+        return size_;
+    }
+};
+
+namespace detail {
+
+template<typename T, typename Op>
+void combine(ConstMatrixView<T> x, ConstMatrixView<T> y, MatrixView<T> dst, Op op) {
+    for (std::size_t i = 0; i < dst.rows(); ++i) {
+        for (std::size_t j = 0; j < dst.cols(); ++j) {
+            dst(i, j) = op(x(i, j), y(i, j));
+        }
+    }
+}
+
+template<typename T>
+void add(ConstMatrixView<T> x, ConstMatrixView<T> y, MatrixView<T> dst) {
+    combine(x, y, dst, [] (const T& lhs, const T& rhs) { return lhs + rhs; });
+}
+
+template<typename T>
+void sub(ConstMatrixView<T> x, ConstMatrixView<T> y, MatrixView<T> dst) {
+    combine(x, y, dst, [] (const T& lhs, const T& rhs) { return lhs - rhs; });
+}
+
+template<typename T>
+void strassenRec(ConstMatrixView<T> a, ConstMatrixView<T> b, MatrixView<T> c, T* ws, std::size_t cutoff) {
+    std::size_t n = a.rows();
+    if (n <= cutoff) {
+        c.fill(T{});
+        gemm(a, b, c);
+        return;
+    }
+    if (n % 2U != 0U) {
+        std::size_t m = n - 1U;
+        strassenRec(a.block(0, 0, m, m), b.block(0, 0, m, m), c.block(0, 0, m, m), ws, cutoff);
+        gemm(a.block(0, m, m, 1), b.block(m, 0, 1, m), c.block(0, 0, m, m));
+        c.block(0, m, m, 1).fill(T{});
+        gemm(a.block(0, 0, m, n), b.block(0, m, n, 1), c.block(0, m, m, 1));
+        c.block(m, 0, 1, n).fill(T{});
+        gemm(a.block(m, 0, 1, n), b, c.block(m, 0, 1, n));
+        return;
+    }
+
+    std::size_t h = n / 2U;
+    auto a11 = a.block(0, 0, h, h), a12 = a.block(0, h, h, h);
+    auto a21 = a.block(h, 0, h, h), a22 = a.block(h, h, h, h);
+    auto b11 = b.block(0, 0, h, h), b12 = b.block(0, h, h, h);
+    auto b21 = b.block(h, 0, h, h), b22 = b.block(h, h, h, h);
+    auto c11 = c.block(0, 0, h, h), c12 = c.block(0, h, h, h);
+    auto c21 = c.block(h, 0, h, h), c22 = c.block(h, h, h, h);
+    MatrixView<T> x{ws, h, h, h};
+    MatrixView<T> y{ws + h * h, h, h, h};
+    T* next = ws + 2U * h * h;
+
+    sub<T>(a11, a21, x);                       //S3
+    sub<T>(b22, b12, y);                       //T3
+    strassenRec<T>(x, y, c21, next, cutoff);   //P7 = S3 * T3
+    add<T>(a21, a22, x);                       //S1
+    sub<T>(b12, b11, y);                       //T1
+    strassenRec<T>(x, y, c22, next, cutoff);   //P5 = S1 * T1
+    sub<T>(x, a11, x);                         //S2 = S1 - A11
+    sub<T>(b22, y, y);                         //T2 = B22 - T1
+    strassenRec<T>(x, y, c12, next, cutoff);   //P6 = S2 * T2
+    sub<T>(a12, x, x);                         //S4 = A12 - S2
+    strassenRec<T>(x, b22, c11, next, cutoff); //P3 = S4 * B22
+    strassenRec<T>(a11, b11, x, next, cutoff); //P1
+    add<T>(x, c12, c12);                       //U2 = P1 + P6
+    add<T>(c12, c21, c21);                     //U3 = U2 + P7
+    add<T>(c12, c22, c12);                     //U4 = U2 + P5
+    add<T>(c21, c22, c22);                     //U7 = U3 + P5 = C22
+    add<T>(c12, c11, c12);                     //U5 = U4 + P3 = C12
+    sub<T>(y, b21, y);                         //T4 = T2 - B21
+    strassenRec<T>(a22, y, c11, next, cutoff); //P4 = A22 * T4
+    sub<T>(c21, c11, c21);                     //U6 = U3 - P4 = C21
+    strassenRec<T>(a12, b21, c11, next, cutoff); //P2
+    add<T>(x, c11, c11);                       //U1 = P1 + P2 = C11
+}
+
+} //namespace detail
+
+template<typename T>
+void strassen(ConstMatrixView<T> a, ConstMatrixView<T> b, MatrixView<T> c, Arena<T>& arena,
+              std::size_t cutoff = strassenCutoff) {
+    if (!a.square() || a.rows() != b.rows() || a.cols() != b.cols() ||
+        c.rows() != a.rows() || c.cols() != a.cols()) {
+        throw std::logic_error("Strassen: matrices must be square and of the same size");
+    }
+    cutoff = std::max<std::size_t>(cutoff, 1U);
+    arena.reserve(strassenWorkspace(a.rows(), cutoff));
+    detail::strassenRec<T>(a, b, c, arena.data(), cutoff);
+}
+
+template<typename T>
+void strassen(ConstMatrixView<T> a, ConstMatrixView<T> b, MatrixView<T> c, std::size_t cutoff = strassenCutoff) {
+    Arena<T> arena;
+    strassen(a, b, c, arena, cutoff);
+}
+
+template<typename T>
+bool useStrassen(ConstMatrixView<T> lhs, ConstMatrixView<T> rhs) {
+    return lhs.square() && rhs.square() && lhs.rows() >= strassenThreshold && ThreadPool::instance().size() == 1U;
+}
+
+} //namespace matrix
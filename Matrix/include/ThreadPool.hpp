@@ -0,0 +1,134 @@
+#pragma once
+
+/*
+Class ThreadPool. Fixed set of worker threads shared by the parallel algorithms.
+Functionality:
+    static ThreadPool& instance() - pool with hardware_concurrency() threads
+    size_type size() - number of threads that work on a parallel loop
+    void parallelFor(first, last, func) - calls func(begin, end) on chunks of
+        [first, last) and waits for all of them. The calling thread takes a chunk too.
+        Called from a worker thread, the loop runs serially, so nested loops can't deadlock.
+*/
+
+#include <latch>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+namespace matrix {
+
+class ThreadPool final
+{
+    using size_type = std::size_t;
+
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+
+    static bool& insideWorker() {
+        thread_local bool inside = false;
+        return inside;
+    }
+
+    void work() {
+        insideWorker() = true;
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock{mutex_};
+                cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+                if (stop_ && tasks_.empty()) {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            task();
+        }
+    }
+
+public:
+    explicit ThreadPool(size_type nThreads = std::thread::hardware_concurrency()) {
+        for (size_type i = 1; i < nThreads; ++i) {
+            workers_.emplace_back([this] { work(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& worker: workers_) {
+            worker.join();
+        }
+    }
+
+    static ThreadPool& instance() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    size_type size() const {
+        return workers_.size() + 1U;
+    }
+
+    template<typename F>
+    void parallelFor(size_type first, size_type last, F func, size_type minChunk = 1U) {
+        if (first >= last) {
+            return;
+        }
+        size_type count = last - first;
+        size_type nChunks = std::min(size(), (count + minChunk - 1U) / minChunk);
+        if (nChunks <= 1U || insideWorker()) {
+            func(first, last);
+            return;
+        }
+        size_type chunk = (count + nChunks - 1U) / nChunks;
+        nChunks = (count + chunk - 1U) / chunk;
+        std::latch done{static_cast<std::ptrdiff_t>(nChunks - 1U)};
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            for (size_type c = 1; c < nChunks; ++c) {
+                size_type begin = first + c * chunk;
+                size_type end = std::min(begin + chunk, last);
+                tasks_.emplace([&, begin, end] {
+                    try {
+                        func(begin, end);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> errorLock{errorMutex};
+                        error = std::current_exception();
+                    }
+                    done.count_down();
+                });
+            }
+        }
+        cv_.notify_all();
+        try {
+            func(first, first + chunk);
+        } catch (...) {
+            std::lock_guard<std::mutex> errorLock{errorMutex};
+            error = std::current_exception();
+        }
+        done.wait();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+} //namespace matrix
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <cctype>
+#include <charconv>
+#include <streambuf>
+#include <stdexcept>
+#include <type_traits>
 #include <initializer_list>
 
 namespace matrix {
@@ -39,4 +44,29 @@ inline size_t maxNestedLstSize(const std::initializer_list<std::initializer_list
     return maxSize;
 }
 
+inline constexpr size_t maxTokenSize = 128U;
+
+//Reads one whitespace separated number straight from the stream buffer with std::from_chars:
+//no sentry, no locale, no virtual call per character beyond the buffer's own.
+//Throws std::runtime_error on a token longer than maxTokenSize.
+template<typename T>
+inline bool readValue(std::streambuf& buf, T& value) requires std::is_arithmetic_v<T> {
+    char token[maxTokenSize];
+    size_t len = 0U;
+    int c = buf.sgetc();
+    while (c != std::char_traits<char>::eof() && std::isspace(c)) {
+        c = buf.snextc();
+    }
+    while (c != std::char_traits<char>::eof() && !std::isspace(c) && len < maxTokenSize) {
+        token[len++] = static_cast<char>(c);
+        c = buf.snextc();
+    }
+    if (len == maxTokenSize && c != std::char_traits<char>::eof() && !std::isspace(c)) {
+        throw std::runtime_error("Number is longer than maxTokenSize characters");
+    }
+    const char* first = (len != 0U && token[0] == '+') ? token + 1 : token;
+    auto [ptr, ec] = std::from_chars(first, token + len, value);
+    return len != 0U && ec == std::errc{} && ptr == token + len;
+}
+
 } //namespace matrix
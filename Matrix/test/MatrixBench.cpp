@@ -0,0 +1,195 @@
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <iostream>
+#include <filesystem>
+#include "../include/Matrix.hpp"
+#include "../include/MatrixIO.hpp"
+
+using namespace matrix;
+
+//Usage: matrix_bench [maxN [maxCubicN [maxTextN]]]
+//Sizes are powers of two from 16. O(n^2) operations run up to maxN (8192), O(n^3) ones
+//(multiply, det) up to maxCubicN (1024), text I/O up to maxTextN (2048).
+//Each row: operation, type, n, time of one run, GFLOP/s, GB/s of compulsory traffic.
+//Operands are bounded: integer runs never overflow.
+//The "peak" rows are practical ceilings of this build: memcpy bandwidth and independent
+//multiply-adds from registers. The bench is built for the baseline ISA (no -march, no
+//-mfma), so "peak mul+add (baseline ISA)" times a separate multiply and add: it is the
+//ceiling for this binary, not the FMA peak of the hardware.
+namespace {
+
+constexpr double minBenchTime = 0.2;
+
+template<typename F>
+double timeOf(F func) {
+    func();
+    std::size_t reps = 0U;
+    double total = 0.0;
+    while (total < minBenchTime || reps < 3U) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        total += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        reps++;
+    }
+    return total / static_cast<double>(reps);
+}
+
+void report(const std::string& op, const std::string& type, std::size_t n, double time, double flops, double bytes) {
+    std::cout << op << '\t' << type << '\t' << n << '\t' << time * 1e3 << '\t';
+    if (flops > 0.0) {
+        std::cout << flops / time * 1e-9;
+    } else {
+        std::cout << '-';
+    }
+    std::cout << '\t';
+    if (bytes > 0.0) {
+        std::cout << bytes / time * 1e-9;
+    } else {
+        std::cout << '-';
+    }
+    std::cout << std::endl;
+}
+
+template<typename T>
+Matrix<T> random(std::size_t n, std::mt19937& gen) {
+    Matrix<T> res{n, n, uninitialized};
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+            if constexpr (std::is_integral_v<T>) {
+                res[i][j] = static_cast<T>(gen() % 19U) - 9;
+            } else {
+                res[i][j] = std::uniform_real_distribution<T>{T{-1}, T{1}}(gen);
+            }
+        }
+    }
+    return res;
+}
+
+template<typename T>
+void benchType(const std::string& type, std::size_t maxN, std::size_t maxCubicN, std::size_t maxTextN) {
+    std::mt19937 gen{36};
+    auto path = (std::filesystem::temp_directory_path() / "matrix_bench.bin").string();
+    for (std::size_t n = 16U; n <= maxN; n *= 2U) {
+        double elems = static_cast<double>(n) * static_cast<double>(n);
+        double bytes = elems * sizeof(T);
+        double cube = elems * static_cast<double>(n);
+        Matrix<T> lhs{random<T>(n, gen)};
+        Matrix<T> rhs{random<T>(n, gen)};
+
+        report("copy", type, n, timeOf([&] { Matrix<T> copy{lhs}; }), 0.0, 2.0 * bytes);
+        report("move", type, n, timeOf([&] {
+            Matrix<T> moved{std::move(lhs)};
+            lhs = std::move(moved);
+        }), 0.0, 0.0);
+        //Adds and subtracts back, so integer entries don't grow from run to run.
+        report("add+sub", type, n, timeOf([&] {
+            lhs += rhs;
+            lhs -= rhs;
+        }), 2.0 * elems, 6.0 * bytes);
+        report("transpose", type, n, timeOf([&] { lhs.transpose(); }), 0.0, 2.0 * bytes);
+
+        if (n <= maxCubicN) {
+            report("multiply", type, n, timeOf([&] { Matrix<T> product{lhs * rhs}; }), 2.0 * cube, 3.0 * bytes);
+            if constexpr (std::is_floating_point_v<T>) {
+                Matrix<T> mtx{Matrix<T>::eye(n, static_cast<T>(n)) + rhs};
+                volatile T sink{};
+                report("detGauss", type, n, timeOf([&] { sink = mtx.detGauss(); }), 2.0 / 3.0 * cube, bytes);
+                report("detBareiss", type, n, timeOf([&] { sink = mtx.detBareiss(); }), 4.0 / 3.0 * cube, bytes);
+            } else {
+                //det of integers is exact multi-modular, flops are nominal Gauss ones.
+                //Big random determinants don't fit in T: all residues are still computed.
+                volatile T sink{};
+                report("detModular", type, n, timeOf([&] {
+                    try {
+                        sink = rhs.det();
+                    } catch (const std::overflow_error&) {}
+                }), 2.0 / 3.0 * cube, bytes);
+                //Unit upper triangular with random entries above the diagonal: every Bareiss
+                //intermediate equals an entry of the matrix, so nothing overflows, and the
+                //elimination does its full n^3 / 3 steps.
+                Matrix<T> upper{Matrix<T>::eye(n, T{1})};
+                for (std::size_t i = 0; i < n; ++i) {
+                    for (std::size_t j = i + 1; j < n; ++j) {
+                        upper[i][j] = rhs[i][j];
+                    }
+                }
+                report("detBareiss", type, n, timeOf([&] { sink = upper.detBareiss(); }), 4.0 / 3.0 * cube, bytes);
+            }
+        }
+
+        report("writeBinary", type, n, timeOf([&] { writeBinary(path, lhs); }), 0.0, bytes);
+        report("readBinary", type, n, timeOf([&] { Matrix<T> read{readBinary<T>(path)}; }), 0.0, bytes);
+        if (n <= maxTextN) {
+            auto textPath = path + ".txt";
+            double writeTime = timeOf([&] {
+                std::ofstream os{textPath};
+                os << n << '\n';
+                for (std::size_t i = 0; i < n; ++i) {
+                    for (std::size_t j = 0; j < n; ++j) {
+                        os << lhs[i][j] << ' ';
+                    }
+                }
+            });
+            double textBytes = static_cast<double>(std::filesystem::file_size(textPath));
+            report("writeText", type, n, writeTime, 0.0, textBytes);
+            report("readText", type, n, timeOf([&] {
+                std::ifstream is{textPath};
+                BlockReader reader{is};
+                Matrix<T> read{reader.next<std::size_t>(), n, uninitialized};
+                reader.read(read);
+            }), 0.0, textBytes);
+            std::filesystem::remove(textPath);
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+void benchPeak() {
+    constexpr std::size_t n = 2048U;
+    constexpr std::size_t size = n * n * sizeof(double);
+    std::vector<char> src(size, 1);
+    std::vector<char> dst(size);
+    report("peak memcpy", "-", n, timeOf([&] { std::memcpy(dst.data(), src.data(), size); }), 0.0, 2.0 * size);
+
+    constexpr std::size_t accumulators = 16U;
+    constexpr std::size_t iterations = 1U << 22U;
+    volatile double seed = 1.0;
+    double sink = 0.0;
+    report("peak mul+add (baseline ISA)", "double", accumulators, timeOf([&] {
+        double acc[accumulators];
+        for (double& value: acc) {
+            value = seed;
+        }
+        for (std::size_t it = 0; it < iterations; ++it) {
+            for (double& value: acc) {
+                value = value * 0.999999 + 1e-6;
+            }
+        }
+        for (double value: acc) {
+            sink += value;
+        }
+    }), 2.0 * accumulators * iterations, 0.0);
+    seed = sink;
+}
+
+} //namespace
+
+int main(int argc, char** argv) {
+    std::size_t maxN = argc > 1 ? std::stoul(argv[1]) : 8192U;
+    std::size_t maxCubicN = argc > 2 ? std::stoul(argv[2]) : 1024U;
+    std::size_t maxTextN = argc > 3 ? std::stoul(argv[3]) : 2048U;
+    try {
+        std::cout << "op\ttype\tn\tms\tGFLOP/s\tGB/s" << std::endl;
+        benchPeak();
+        benchType<int>("int", maxN, maxCubicN, maxTextN);
+        benchType<float>("float", maxN, maxCubicN, maxTextN);
+        benchType<double>("double", maxN, maxCubicN, maxTextN);
+    } catch (const std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,9 +1,50 @@
+#include <random>
 #include <filesystem>
 #include <gtest/gtest.h>
 #include "../include/Matrix.hpp"
+#include "../include/SparseMatrix.hpp"
+#include "../include/MatrixIO.hpp"
+#include "../include/FixedMatrix.hpp"
+#include "../include/MatrixBatch.hpp"
+#include "../include/Solve.hpp"
+#include "../include/Eigen.hpp"
+#include "../include/ProductChain.hpp"
+#include "../include/OutOfCore.hpp"
+#include "../include/Cholesky.hpp"
+#include "../include/QR.hpp"
+#include "../include/LayoutMatrix.hpp"
 
 using namespace matrix;
 
+template<typename T>
+using UniformDistribution = std::conditional_t<std::is_integral_v<T>,
+        std::uniform_int_distribution<T>, std::uniform_real_distribution<T>>;
+
+//uniform values in [lo, hi], the same on every run for a given seed
+template<typename T>
+Matrix<T> randomMatrix(size_t rows, size_t cols, size_t seed, T lo, T hi) {
+    std::mt19937 gen{static_cast<std::mt19937::result_type>(seed)};
+    UniformDistribution<T> dist{lo, hi};
+    Matrix<T> res{rows, cols};
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            res[i][j] = dist(gen);
+        }
+    }
+    return res;
+}
+
+template<typename T>
+std::vector<T> randomVector(size_t size, size_t seed, T lo, T hi) {
+    std::mt19937 gen{static_cast<std::mt19937::result_type>(seed)};
+    UniformDistribution<T> dist{lo, hi};
+    std::vector<T> res(size);
+    for (T& value: res) {
+        value = dist(gen);
+    }
+    return res;
+}
+
 TEST(UnitTestStorage, test0) {
     Storage<int> s1{10, 2};
 
@@ -40,6 +81,33 @@ TEST(UnitTestStorage, test0) {
     EXPECT_TRUE(s6.size() == 6);
 }
 
+TEST(UnitTestStorage, allocators) {
+    Storage<double> s1{100, 1.0};
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(s1.data()) % cacheLineSize, 0U);
+
+    Storage<int> s2{1000, uninitialized};
+    std::fill(s2.begin(), s2.end(), 3);
+    EXPECT_TRUE(s2 == Storage<int>(1000, 3));
+
+    size_t bigSize = 2 * hugePageSize / sizeof(double) + 1;
+    Storage<double, HugePageAllocator<double>> s3{bigSize, 2.0};
+    Storage<double, HugePageAllocator<double>> s4{s3};
+    EXPECT_TRUE(s3 == s4);
+    EXPECT_EQ(s4[bigSize - 1], 2.0);
+
+    Storage<double, HugePageAllocator<double>> s5{10, 2.0};
+    s5 = std::move(s3);
+    EXPECT_EQ(s5.size(), bigSize);
+
+    Matrix<double, HugePageAllocator<double>> m1{1024, 1024};
+    Matrix<double, HugePageAllocator<double>> m2 = m1 + m1;
+    EXPECT_TRUE(m1 == m2);
+
+    Matrix<int> m3{2, 3, uninitialized};
+    m3[1][2] = 5;
+    EXPECT_EQ(m3[1][2], 5);
+}
+
 TEST(UnitTestMatrix, constructors) {
     Matrix<int> m1{{1, 2, 3}, {4, 5, 6}};
 
@@ -111,6 +179,934 @@ TEST(UnitTestMatrix, functionality) {
     EXPECT_TRUE(m15 * Matrix<int>::eye(2, 1) == m15);
 }
 
+TEST(UnitTestMatrix, blockedTranspose) {
+    for (auto [m, n]: {std::pair{37, 37}, std::pair{64, 64}, std::pair{1, 50}, std::pair{45, 70}, std::pair{130, 17}}) {
+        Matrix<int> m1{static_cast<size_t>(m), static_cast<size_t>(n)};
+        for (int i = 0; i < m; ++i) {
+            for (int j = 0; j < n; ++j) {
+                m1[i][j] = i * n + j;
+            }
+        }
+        Matrix<int> m2{m1};
+        m2.transpose();
+        EXPECT_EQ(m2.rows(), static_cast<size_t>(n));
+        EXPECT_EQ(m2.cols(), static_cast<size_t>(m));
+        for (int i = 0; i < m; ++i) {
+            for (int j = 0; j < n; ++j) {
+                EXPECT_EQ(m2[j][i], m1[i][j]);
+            }
+        }
+        m2.transpose();
+        EXPECT_TRUE(m1 == m2);
+    }
+}
+
+//chain(m) and chain(m) * m compile only for operands that outlive the chain
+template<typename M>
+concept Chainable = requires(M&& mtx) {
+    chain(std::forward<M>(mtx));
+    chain(mtx) * std::forward<M>(mtx);
+};
+
+template<typename T>
+Matrix<T> classicProduct(const Matrix<T>& lhs, const Matrix<T>& rhs) {
+    Matrix<T> res{lhs.rows(), rhs.cols()};
+    for (size_t i = 0; i < lhs.rows(); ++i) {
+        for (size_t j = 0; j < rhs.cols(); ++j) {
+            for (size_t k = 0; k < lhs.cols(); ++k) {
+                res[i][j] += lhs[i][k] * rhs[k][j];
+            }
+        }
+    }
+    return res;
+}
+
+TEST(UnitTestMatrix, rvalueOperators) {
+    Matrix<int> a{{1, 2}, {3, 4}};
+    Matrix<int> b{{5, 6}, {7, 8}};
+
+    Matrix<int> t1{a};
+    const int* p1 = t1[0].data();
+    Matrix<int> r1 = std::move(t1) + b;
+    EXPECT_EQ(r1[0].data(), p1);
+    EXPECT_TRUE(r1 == (Matrix<int>{{6, 8}, {10, 12}}));
+
+    Matrix<int> t2{b};
+    const int* p2 = t2[0].data();
+    Matrix<int> r2 = a - std::move(t2);
+    EXPECT_EQ(r2[0].data(), p2);
+    EXPECT_TRUE(r2 == (Matrix<int>{{-4, -4}, {-4, -4}}));
+
+    Matrix<int> r3 = (a + b) - (b - a) + a;
+    EXPECT_TRUE(r3 == (Matrix<int>{{3, 6}, {9, 12}}));
+    EXPECT_TRUE(2 * (a * 3) / 6 == a);
+    EXPECT_TRUE(a * (b * a) == (a * b) * a);
+    EXPECT_TRUE(a * Matrix<int>{b} == (Matrix<int>{{19, 22}, {43, 50}}));
+    EXPECT_THROW(a - Matrix<int>(3, 3), std::logic_error);
+
+    //Repeated products of one shape swap between the matrix and the scratch buffer
+    Matrix<int> c{a};
+    c *= b;
+    const int* p3 = c[0].data();
+    c *= b;
+    EXPECT_NE(c[0].data(), p3);
+    c *= b;
+    EXPECT_EQ(c[0].data(), p3);
+    EXPECT_TRUE(c == a * b * b * b);
+}
+
+TEST(UnitTestMatrix, powAndGemv) {
+    Matrix<long> fib{{1, 1}, {1, 0}};
+    EXPECT_TRUE(pow(fib, 0) == Matrix<long>::eye(2, 1));
+    EXPECT_TRUE(pow(fib, 1) == fib);
+    EXPECT_EQ(pow(fib, 10)[0][1], 55);
+    EXPECT_EQ(pow(fib, 90)[0][1], 2880067194370816120L);
+
+    Matrix<long> a{{1, 2, 0}, {0, 1, 3}, {1, 0, 1}};
+    Matrix<long> naive = Matrix<long>::eye(3, 1);
+    for (int k = 0; k < 13; ++k) {
+        naive *= a;
+    }
+    EXPECT_TRUE(pow(a, 13) == naive);
+    EXPECT_THROW(pow(Matrix<long>(2, 3), 2), std::logic_error);
+
+    std::vector<long> x{1, -1, 2};
+    std::vector<long> y(3, 1);
+    gemv<long>(a.view(), x, y);
+    EXPECT_EQ(y, (std::vector<long>{0, 6, 4}));
+    std::vector<long> expected(3);
+    gemv<long>(naive.view(), x, expected);
+    EXPECT_EQ(powApply(a, 13, x), expected);
+    EXPECT_EQ(powApply(a, 0, x), x);
+    Matrix<long> p1000 = pow(Matrix<long>{{1, 1}, {0, 1}}, 1000);
+    EXPECT_EQ(p1000[0][1], 1000);
+    EXPECT_EQ(powApply(Matrix<long>{{1, 1}, {0, 1}}, 1000, std::vector<long>{0, 1}), (std::vector<long>{1000, 1}));
+    EXPECT_THROW(gemv<long>(a.view(), std::vector<long>{1, 2}, y), std::logic_error);
+}
+
+TEST(UnitTestMatrix, blockedGemm) {
+    Matrix<long> m1{70, 300};
+    Matrix<long> m2{300, 600};
+    for (size_t i = 0; i < 300; ++i) {
+        for (size_t j = 0; j < 70; ++j) {
+            m1[j][i] = static_cast<long>(i * 7 + j * 3) % 19 - 9;
+        }
+        for (size_t j = 0; j < 600; ++j) {
+            m2[i][j] = static_cast<long>(i * 5 + j * 11) % 23 - 11;
+        }
+    }
+    EXPECT_TRUE(m1 * m2 == classicProduct(m1, m2));
+
+    Matrix<long> m3{600, 70};
+    gemm<long>(m2.view().transposed(), m1.view().transposed(), m3.view());
+    Matrix<long> m4{classicProduct(m1, m2)};
+    m4.transpose();
+    EXPECT_TRUE(m3 == m4);
+    EXPECT_THROW(gemm<long>(m1.view(), m1.view(), m3.view()), std::logic_error);
+}
+
+TEST(UnitTestMatrix, strassen) {
+    for (size_t n: {1U, 16U, 67U, 128U, 203U}) {
+        Matrix<double> m1 = randomMatrix(n, n, 2 * n, -1.0, 1.0);
+        Matrix<double> m2 = randomMatrix(n, n, 2 * n + 1, -1.0, 1.0);
+        Matrix<double> classic{classicProduct(m1, m2)};
+        Matrix<double> fast{n, n};
+        Arena<double> arena;
+        strassen<double>(m1.view(), m2.view(), fast.view(), arena, 8);
+        EXPECT_LE(arena.size(), strassenWorkspace(n, 8));
+        double maxError = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                maxError = std::max(maxError, std::abs(fast[i][j] - classic[i][j]));
+            }
+        }
+        EXPECT_LT(maxError, 1e-13 * static_cast<double>(n));
+    }
+
+    Matrix<long> m3{99, 99};
+    for (size_t i = 0; i < 99; ++i) {
+        for (size_t j = 0; j < 99; ++j) {
+            m3[i][j] = static_cast<long>(i * i + 3 * j) % 17 - 8;
+        }
+    }
+    Matrix<long> m4{99, 99};
+    strassen<long>(m3.view(), m3.view().transposed(), m4.view(), 4);
+    Matrix<long> m5{m3};
+    m5.transpose();
+    EXPECT_TRUE(m4 == classicProduct(m3, m5));
+
+    Matrix<long> m6{99, 98};
+    EXPECT_THROW(strassen<long>(m6.view(), m6.view(), m4.view()), std::logic_error);
+}
+
+TEST(UnitTestMatrix, productChain) {
+    std::vector<size_t> dims{30, 35, 15, 5, 10, 20, 25};
+    std::vector<Matrix<long>> mtxs;
+    for (size_t k = 0; k + 1 < dims.size(); ++k) {
+        Matrix<long> mtx{dims[k], dims[k + 1]};
+        for (size_t i = 0; i < dims[k]; ++i) {
+            for (size_t j = 0; j < dims[k + 1]; ++j) {
+                mtx[i][j] = static_cast<long>((i * 3 + j * 7 + k) % 11) - 5;
+            }
+        }
+        mtxs.push_back(mtx);
+    }
+    ProductChain<long> prod = chain(mtxs[0]) * mtxs[1] * mtxs[2] * mtxs[3] * mtxs[4] * mtxs[5];
+    EXPECT_EQ(prod.size(), 6U);
+    EXPECT_EQ(prod.cost(), 15125U);
+    EXPECT_EQ(prod.order(), "((A0 (A1 A2)) ((A3 A4) A5))");
+    Matrix<long> expected = mtxs[0] * mtxs[1] * mtxs[2] * mtxs[3] * mtxs[4] * mtxs[5];
+    Matrix<long> lazy = prod;
+    EXPECT_TRUE(lazy == expected);
+    EXPECT_TRUE((chain(mtxs[0]) * mtxs[1] * (chain(mtxs[2]) * mtxs[3])).eval() == mtxs[0] * mtxs[1] * mtxs[2] * mtxs[3]);
+    EXPECT_TRUE(chain(mtxs[2]).eval() == mtxs[2]);
+    EXPECT_THROW(chain(mtxs[0]) * mtxs[2], std::logic_error);
+    EXPECT_THROW(ProductChain<long>{}.eval(), std::logic_error);
+    static_assert(Chainable<Matrix<long>&>);
+    static_assert(!Chainable<Matrix<long>>);
+}
+
+TEST(UnitTestSparseMatrix, functionality) {
+    std::vector<Triplet<int>> triplets{{0, 1, 2}, {2, 0, 4}, {0, 1, 3}, {1, 2, 7}, {2, 2, 0}};
+    SparseMatrix<int> s1{3, 3, triplets};
+    Matrix<int> m1{{0, 5, 0}, {0, 0, 7}, {4, 0, 0}};
+    EXPECT_EQ(s1.nnz(), 3U);
+    EXPECT_EQ(s1.at(0, 1), 5);
+    EXPECT_EQ(s1.at(1, 1), 0);
+    EXPECT_TRUE(s1.toDense() == m1);
+    EXPECT_TRUE(SparseMatrix<int>{m1} == s1);
+
+    SparseMatrix<int> s2{s1};
+    s2.transpose();
+    Matrix<int> m2{m1};
+    m2.transpose();
+    EXPECT_TRUE(s2.toDense() == m2);
+
+    EXPECT_TRUE((s1 + s2).toDense() == m1 + m2);
+    EXPECT_TRUE((s1 - s1).nnz() == 0U);
+    EXPECT_TRUE(SparseMatrix<int>::eye(3, 2).toDense() == Matrix<int>::eye(3, 2));
+    EXPECT_TRUE(SparseMatrix<int>::diag(3, {1, 2, 3}).toDense() == Matrix<int>::diag(3, {1, 2, 3}));
+
+    std::vector<int> x{1, 2, 3};
+    std::vector<int> y{10, 21, 4};
+    EXPECT_TRUE(s1 * x == y);
+
+    Matrix<int> m3{{1, 2}, {3, 4}, {5, 6}};
+    EXPECT_TRUE(s1 * m3 == m1 * m3);
+}
+
+TEST(UnitTestSparseMatrix, det) {
+    Matrix<double> m1{{0, 2, 0, 1}, {3, 0, 0, 0}, {0, 0, 4, 5}, {1, 0, 2, 0}};
+    EXPECT_TRUE(::matrix::equals(SparseMatrix<double>{m1}.det(), m1.det()));
+
+    Matrix<double> m2{{1, 2, 0}, {2, 4, 0}, {0, 0, 1}};
+    EXPECT_TRUE(::matrix::equals(SparseMatrix<double>{m2}.det(), 0.0));
+
+    size_t n = 200;
+    std::vector<Triplet<double>> triplets;
+    for (size_t i = 0; i < n; ++i) {
+        triplets.push_back({i, i, 2.0});
+        if (i + 1 < n) {
+            triplets.push_back({i, i + 1, -1.0});
+            triplets.push_back({i + 1, i, -1.0});
+        }
+    }
+    SparseMatrix<double> s3{n, n, triplets};
+    EXPECT_TRUE(::matrix::equals(s3.det(), static_cast<double>(n + 1)));
+    EXPECT_TRUE(::matrix::equals(s3.det(), s3.toDense().det()));
+}
+
+TEST(UnitTestMatrixView, functionality) {
+    Matrix<int> m1{{1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12}};
+    auto v1 = m1.block(1, 1, 2, 3);
+    EXPECT_EQ(v1.rows(), 2U);
+    EXPECT_EQ(v1[1][2], 12);
+    EXPECT_THROW(v1[2][0], std::out_of_range);
+    EXPECT_THROW(m1.block(2, 0, 2, 1), std::out_of_range);
+    EXPECT_TRUE(Matrix<int>{v1} == Matrix<int>({{6, 7, 8}, {10, 11, 12}}));
+    EXPECT_TRUE(Matrix<int>{m1.view().row(2)} == Matrix<int>({{9, 10, 11, 12}}));
+    EXPECT_TRUE(Matrix<int>{m1.view().col(1)} == Matrix<int>({{2}, {6}, {10}}));
+
+    Matrix<int> m2{m1};
+    m2.transpose();
+    EXPECT_TRUE(Matrix<int>{m1.view().transposed()} == m2);
+    EXPECT_TRUE(Matrix<int>{v1.transposed().block(1, 0, 2, 2)} == Matrix<int>({{7, 11}, {8, 12}}));
+
+    Matrix<int> m5{m1};
+    v1 += m5.block(0, 0, 2, 3);
+    EXPECT_TRUE(m1 == Matrix<int>({{1, 2, 3, 4}, {5, 7, 9, 11}, {9, 15, 17, 19}}));
+    v1.fill(0);
+    v1 *= 3;
+    EXPECT_TRUE(m1 == Matrix<int>({{1, 2, 3, 4}, {5, 0, 0, 0}, {9, 0, 0, 0}}));
+
+    const Matrix<int> m3{{1, 2}, {3, 4}};
+    ConstMatrixView<int> v3 = m3.view();
+    EXPECT_TRUE(v3 + v3 == m3 * 2);
+    EXPECT_TRUE(v3 - v3 == Matrix<int>(2, 2));
+    EXPECT_TRUE(v3 * v3.transposed() == Matrix<int>({{5, 11}, {11, 25}}));
+    EXPECT_TRUE(2 * v3 == v3 / 1 * 2);
+    EXPECT_EQ(det(v3), -2);
+
+    Matrix<int> m4{{1, 1}, {1, 1}};
+    m4 *= m3.view().transposed();
+    EXPECT_TRUE(m4 == Matrix<int>({{3, 7}, {3, 7}}));
+
+    std::stringstream ss{"7 8"};
+    ss >> m1.view().row(0).block(0, 2, 1, 2);
+    EXPECT_EQ(m1[0][3], 8);
+    std::stringstream out;
+    out << m3.view().col(0);
+    EXPECT_EQ(out.str(), "M 2; N 1\n   1 \n   3 \n");
+}
+
+TEST(UnitTestFixedMatrix, functionality) {
+    constexpr FixedMatrix<int, 2, 2> f1{{1, 2}, {3, 4}};
+    static_assert(f1.det() == -2);
+    static_assert((f1 * f1)[1][0] == 15);
+    static_assert(FixedMatrix<int, 3, 3>::eye(2).det() == 8);
+
+    //2 on the diagonal, 1 elsewhere: det = (N + 1)
+    static_assert(FixedMatrix<int, 5, 5>{{2, 1, 1, 1, 1}, {1, 2, 1, 1, 1}, {1, 1, 2, 1, 1},
+                                         {1, 1, 1, 2, 1}, {1, 1, 1, 1, 2}}.det() == 6);
+    FixedMatrix<long long, 6, 6> f6{Matrix<long long>{{0, 2, 0, 0, 0, 0}, {3, 0, 0, 0, 0, 0}, {0, 0, 0, 0, 0, 5},
+                                                      {0, 0, 7, 1, 0, 0}, {0, 0, 0, 0, 11, 0}, {0, 0, 1, 1, 0, 1}}};
+    EXPECT_EQ(f6.det(), f6.toMatrix().det());
+    EXPECT_EQ((FixedMatrix<int, 5, 5>{}.det()), 0);
+    //2^62 on the diagonal: the second Bareiss step needs 2^186
+    EXPECT_THROW((FixedMatrix<long long, 5, 5>::eye(1LL << 62).det()), std::overflow_error);
+    //2^50 is exact in 128 bits but doesn't fit in int
+    EXPECT_THROW((FixedMatrix<int, 5, 5>::eye(1 << 10).det()), std::overflow_error);
+    EXPECT_EQ((FixedMatrix<long long, 5, 5>::eye(1LL << 10).det()), 1LL << 50);
+    //a row swap: det = -1 doesn't fit in unsigned
+    FixedMatrix<unsigned, 5, 5> swapped = FixedMatrix<unsigned, 5, 5>::eye(1U);
+    swapped[0][0] = 0U;
+    swapped[1][1] = 0U;
+    swapped[0][1] = 1U;
+    swapped[1][0] = 1U;
+    EXPECT_THROW(swapped.det(), std::overflow_error);
+    swapped[2][2] = 0U;
+    swapped[2][3] = 1U;
+    swapped[3][3] = 0U;
+    swapped[3][2] = 1U;
+    EXPECT_EQ(swapped.det(), 1U);
+
+    FixedMatrix<int, 2, 3> f2{{1, 2, 3}, {4, 5, 6}};
+    FixedMatrix<int, 3, 2> f3 = f2.transposed();
+    EXPECT_EQ(f3.at(2, 1), 6);
+    EXPECT_THROW(f3.at(3, 0), std::out_of_range);
+    EXPECT_TRUE((f2 * f3).toMatrix() == Matrix<int>({{14, 32}, {32, 77}}));
+    EXPECT_TRUE(f2 + f2 == 2 * f2);
+    EXPECT_TRUE((f2 - f2 == FixedMatrix<int, 2, 3>{}));
+
+    Matrix<double> m1{{2, -3, 1, 5}, {2, 0, -1, 1}, {1, 4, 5, 0}, {3, 1, 1, 2}};
+    FixedMatrix<double, 4, 4> f4{m1};
+    EXPECT_TRUE(::matrix::equals(f4.det(), m1.det()));
+    EXPECT_TRUE((f4 * f4.inverse() == FixedMatrix<double, 4, 4>::eye(1.0)));
+    FixedMatrix<double, 3, 3> f5{m1.block(0, 0, 3, 3)};
+    EXPECT_TRUE(::matrix::equals(f5.det(), 49.0));
+    EXPECT_TRUE((f5.inverse() * f5 == FixedMatrix<double, 3, 3>::eye(1.0)));
+    EXPECT_THROW((FixedMatrix<double, 3, 3>{m1}), std::logic_error);
+
+    Matrix<double> m2 = Matrix<double>::eye(6, 2);
+    m2[0][5] = 7;
+    EXPECT_TRUE(::matrix::equals(FixedMatrix<double, 6, 6>{m2}.det(), 64.0));
+
+    std::vector<FixedMatrix<double, 3, 3>> batch;
+    for (int k = 0; k < 37; ++k) {
+        batch.push_back({{k + 1.0, 2, 0}, {1, 3, k * 0.5}, {0, 1, 1}});
+    }
+    std::vector<double> dets(batch.size());
+    detBatch<double, 3>(batch, dets);
+    for (size_t k = 0; k < batch.size(); ++k) {
+        EXPECT_TRUE(::matrix::equals(dets[k], batch[k].det()));
+    }
+}
+
+TEST(UnitTestMatrixBatch, det) {
+    for (size_t n: {1U, 8U, 17U, 64U}) {
+        std::vector<Matrix<double>> mtxs;
+        for (size_t k = 0; k < 37; ++k) {
+            Matrix<double> mtx = randomMatrix(n, n, 100 * n + k, -1.0, 1.0);
+            if (k == 5 && n > 1) {
+                for (size_t j = 0; j < n; ++j) {
+                    mtx[n - 1][j] = 2.0 * mtx[0][j];
+                }
+            }
+            mtxs.push_back(mtx);
+        }
+        std::vector<double> dets = detBatch<double>(mtxs);
+        ASSERT_EQ(dets.size(), mtxs.size());
+        for (size_t k = 0; k < mtxs.size(); ++k) {
+            double expected = mtxs[k].det();
+            EXPECT_NEAR(dets[k], expected, 1e-9 * std::max(1.0, std::abs(expected)));
+        }
+        MatrixBatch<double> batch{mtxs};
+        EXPECT_TRUE(batch.get(20) == mtxs[20]);
+    }
+
+    std::vector<Matrix<int>> ints{Matrix<int>{{2, 1}, {1, 2}}, Matrix<int>{{1, 2}, {2, 4}}, Matrix<int>{{0, 1}, {1, 0}}};
+    EXPECT_EQ(detBatch<int>(ints), (std::vector<int>{3, 0, -1}));
+    ints.push_back(Matrix<int>{3, 3});
+    EXPECT_THROW(detBatch<int>(ints), std::logic_error);
+}
+
+TEST(UnitTestSolve, mixedPrecision) {
+    size_t n = 150;
+    Matrix<double> a = randomMatrix(n, n, 35, -1.0, 1.0);
+    std::vector<double> expected = randomVector(n, 36, -1.0, 1.0);
+    for (size_t i = 0; i < n; ++i) {
+        a[i][i] += static_cast<double>(n);
+    }
+    std::vector<double> b(n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            b[i] += a[i][j] * expected[j];
+        }
+    }
+    SolveResult<double> res = solveRefined(a, b);
+    EXPECT_TRUE(res.mixed);
+    EXPECT_GT(res.iterations, 0U);
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_NEAR(res.x[i], expected[i], 1e-13);
+    }
+    LU<double> lu{Matrix<double>{{4.0, 3.0, 1.0}, {6.0, 3.0, 0.0}, {1.0, 1.0, 1.0}}};
+    EXPECT_NEAR(lu.det(), -3.0, 1e-12);
+    EXPECT_EQ(lu.permutation()[0], 1U);
+
+    //Hilbert matrix: float factors can't refine it, the double fallback solves it
+    size_t h = 9;
+    Matrix<double> hilbert{h, h};
+    std::vector<double> ones(h, 1.0);
+    std::vector<double> hb(h);
+    for (size_t i = 0; i < h; ++i) {
+        for (size_t j = 0; j < h; ++j) {
+            hilbert[i][j] = 1.0 / static_cast<double>(i + j + 1);
+            hb[i] += hilbert[i][j];
+        }
+    }
+    SolveResult<double> hres = solveRefined(hilbert, hb);
+    EXPECT_FALSE(hres.mixed);
+    for (size_t i = 0; i < h; ++i) {
+        EXPECT_NEAR(hres.x[i], 1.0, 1e-3);
+    }
+
+    Matrix<double> singular{{1.0, 2.0}, {2.0, 4.0}};
+    EXPECT_THROW(solve(singular, std::vector<double>{1.0, 2.0}), std::runtime_error);
+    EXPECT_THROW(solve(singular, std::vector<double>{1.0}), std::logic_error);
+    EXPECT_THROW(solve(Matrix<double>{2, 3}, std::vector<double>{1.0, 2.0}), std::logic_error);
+}
+
+TEST(UnitTestEigen, symmetric) {
+    EigenResult<double> small = symmetricEigen(Matrix<double>{{2.0, 1.0}, {1.0, 2.0}});
+    EXPECT_NEAR(small.values[0], 1.0, 1e-12);
+    EXPECT_NEAR(small.values[1], 3.0, 1e-12);
+    EXPECT_NEAR(std::abs(small.vectors[0][1]), std::sqrt(0.5), 1e-12);
+    EXPECT_NEAR(symmetricEigen(Matrix<double>{{5.0}}).values[0], 5.0, 1e-12);
+
+    for (size_t n: {3U, 33U, 40U, 101U}) {
+        Matrix<double> a = randomMatrix(n, n, n, -1.0, 1.0);
+        double trace = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < i; ++j) {
+                a[j][i] = a[i][j];
+            }
+            trace += a[i][i];
+        }
+        EigenResult<double> res = symmetricEigen(a);
+        ASSERT_EQ(res.values.size(), n);
+        EXPECT_TRUE(std::is_sorted(res.values.begin(), res.values.end()));
+        EXPECT_NEAR(std::accumulate(res.values.begin(), res.values.end(), 0.0), trace, 1e-10);
+        Matrix<double> av = a * res.vectors;
+        Matrix<double> vtv = Matrix<double>{res.vectors}.transpose() * res.vectors;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                EXPECT_NEAR(av[i][j], res.values[j] * res.vectors[i][j], 1e-10);
+                EXPECT_NEAR(vtv[i][j], i == j ? 1.0 : 0.0, 1e-10);
+            }
+        }
+        std::vector<double> values = eigenvalues(a);
+        for (size_t i = 0; i < n; ++i) {
+            EXPECT_NEAR(values[i], res.values[i], 1e-10);
+        }
+    }
+    EXPECT_THROW(eigenvalues(Matrix<double>{2, 3}), std::logic_error);
+}
+
+TEST(UnitTestOutOfCore, gemmAndLU) {
+    //unique names, so concurrent runs of the test don't share files
+    auto prefix = "ooc_" + std::to_string(std::random_device{}()) + "_";
+    auto dir = std::filesystem::temp_directory_path();
+    auto pathA = (dir / (prefix + "a.tiled")).string();
+    auto pathB = (dir / (prefix + "b.tiled")).string();
+    auto pathC = (dir / (prefix + "c.tiled")).string();
+
+    Matrix<double> a = randomMatrix(37, 29, 42, -1.0, 1.0);
+    Matrix<double> b = randomMatrix(29, 41, 43, -1.0, 1.0);
+    {
+        OutOfCoreMatrix<double> oa{pathA, 37, 29, 8, 6};
+        OutOfCoreMatrix<double> ob{pathB, 29, 41, 8, 6};
+        OutOfCoreMatrix<double> oc{pathC, 37, 41, 8, 3};
+        oa.assign(a.view());
+        ob.assign(b.view());
+        EXPECT_EQ(oa.tileRows(), 5U);
+        EXPECT_EQ(ob.tileCols(), 6U);
+        gemm(oa, ob, oc);
+        Matrix<double> product = a * b;
+        Matrix<double> res = oc.toMatrix();
+        for (size_t i = 0; i < 37; ++i) {
+            for (size_t j = 0; j < 41; ++j) {
+                EXPECT_NEAR(res[i][j], product[i][j], 1e-12);
+            }
+        }
+        EXPECT_THROW(gemm(oa, oa, oc), std::logic_error);
+    }
+    {
+        OutOfCoreMatrix<double> reopened{pathC, 2};
+        EXPECT_EQ(reopened.rows(), 37U);
+        EXPECT_EQ(reopened.cols(), 41U);
+        EXPECT_NEAR(reopened.toMatrix()[36][40], (a * b)[36][40], 1e-12);
+        EXPECT_THROW(OutOfCoreMatrix<float>(pathC, 2), std::runtime_error);
+    }
+    {
+        //the smallest caches: prefetches in flight take the only free slot again and again
+        Matrix<double> sa = randomMatrix(64, 64, 44, -1.0, 1.0);
+        Matrix<double> sb = randomMatrix(64, 64, 45, -1.0, 1.0);
+        Matrix<double> product = sa * sb;
+        OutOfCoreMatrix<double> oa{pathA, 64, 64, 8, gemmMinCacheTiles};
+        OutOfCoreMatrix<double> ob{pathB, 64, 64, 8, gemmMinCacheTiles};
+        oa.assign(sa.view());
+        ob.assign(sb.view());
+        for (size_t run = 0; run < 20U; ++run) {
+            OutOfCoreMatrix<double> oc{pathC, 64, 64, 8, gemmMinCacheTiles};
+            gemm(oa, ob, oc);
+            Matrix<double> res = oc.toMatrix();
+            for (size_t i = 0; i < 64; ++i) {
+                for (size_t j = 0; j < 64; ++j) {
+                    ASSERT_NEAR(res[i][j], product[i][j], 1e-12);
+                }
+            }
+        }
+        OutOfCoreMatrix<double> tiny{pathC, 64, 64, 8, 1};
+        EXPECT_THROW(gemm(oa, ob, tiny), std::logic_error);
+    }
+
+    Matrix<double> m = randomMatrix(45, 45, 46, -1.0, 1.0);
+    std::vector<double> rhs = randomVector(45, 47, -1.0, 1.0);
+    {
+        OutOfCoreMatrix<double> om{pathA, 45, 45, 8, 9};
+        om.assign(m.view());
+        TiledLU<double> lu{om};
+        EXPECT_FALSE(lu.singular());
+        EXPECT_NEAR(lu.det(), m.detGauss(), 1e-10 * std::abs(m.detGauss()));
+        std::vector<double> x = lu.solve(rhs);
+        std::vector<double> expected = LU<double>{m}.solve(rhs);
+        for (size_t i = 0; i < 45; ++i) {
+            EXPECT_NEAR(x[i], expected[i], 1e-9);
+        }
+
+        OutOfCoreMatrix<double> small{pathB, 45, 45, 8, 8};
+        EXPECT_THROW(TiledLU<double>{small}, std::logic_error);
+    }
+    {
+        OutOfCoreMatrix<double> zero{pathA, 20, 20, 8, 6};
+        TiledLU<double> lu{zero};
+        EXPECT_TRUE(lu.singular());
+        EXPECT_EQ(lu.det(), 0.0);
+        EXPECT_THROW(lu.solve(std::vector<double>(20)), std::runtime_error);
+    }
+    std::filesystem::remove(pathA);
+    std::filesystem::remove(pathB);
+    std::filesystem::remove(pathC);
+}
+
+TEST(UnitTestFactorizations, cholesky) {
+    for (size_t n: {1U, 7U, 150U}) {
+        Matrix<double> b = randomMatrix(n, n, n, -1.0, 1.0);
+        Matrix<double> a = b * Matrix<double>{b}.transpose() + Matrix<double>::eye(n, 1.0);
+        Cholesky<double> chol{a};
+        ASSERT_TRUE(chol.positive());
+        Matrix<double> l = chol.factor();
+        Matrix<double> llt = l * Matrix<double>{l}.transpose();
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                EXPECT_NEAR(llt[i][j], a[i][j], 1e-10);
+                if (j > i) {
+                    EXPECT_EQ(l[i][j], 0.0);
+                }
+            }
+        }
+        std::vector<double> rhs(n, 1.0);
+        std::vector<double> x = chol.solve(rhs);
+        std::vector<double> expected = LU<double>{a}.solve(rhs);
+        for (size_t i = 0; i < n; ++i) {
+            EXPECT_NEAR(x[i], expected[i], 1e-9);
+        }
+        if (n < 10U) {
+            EXPECT_NEAR(chol.det(), a.detGauss(), 1e-9 * std::abs(a.detGauss()));
+        }
+    }
+    Cholesky<double> indefinite{Matrix<double>{{1.0, 2.0}, {2.0, 1.0}}};
+    EXPECT_FALSE(indefinite.positive());
+    EXPECT_THROW(indefinite.solve({1.0, 1.0}), std::runtime_error);
+    EXPECT_THROW(Cholesky<double>{Matrix<double>(2, 3)}, std::logic_error);
+}
+
+TEST(UnitTestFactorizations, qr) {
+    for (auto [m, n]: {std::pair<size_t, size_t>{5U, 5U}, {90U, 70U}, {40U, 75U}}) {
+        Matrix<double> a = randomMatrix(m, n, m * n, -1.0, 1.0);
+        QR<double> qr{a};
+        Matrix<double> q = qr.q();
+        Matrix<double> r = qr.r();
+        Matrix<double> product = q * r;
+        Matrix<double> qtq = Matrix<double>{q}.transpose() * q;
+        for (size_t i = 0; i < m; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                EXPECT_NEAR(product[i][j], a[i][j], 1e-12);
+            }
+        }
+        for (size_t i = 0; i < qtq.rows(); ++i) {
+            for (size_t j = 0; j < qtq.cols(); ++j) {
+                EXPECT_NEAR(qtq[i][j], i == j ? 1.0 : 0.0, 1e-12);
+            }
+            for (size_t j = 0; j < std::min(i, r.cols()); ++j) {
+                EXPECT_EQ(r[i][j], 0.0);
+            }
+        }
+        std::vector<double> b = randomVector(m, m * n + 1, -1.0, 1.0);
+        if (m < n) {
+            EXPECT_THROW(qr.solve(b), std::logic_error);
+            continue;
+        }
+        //Least squares residual is orthogonal to the columns of A.
+        std::vector<double> x = qr.solve(b);
+        for (size_t j = 0; j < n; ++j) {
+            double dot = 0.0;
+            for (size_t i = 0; i < m; ++i) {
+                double ri = b[i];
+                for (size_t k = 0; k < n; ++k) {
+                    ri -= a[i][k] * x[k];
+                }
+                dot += a[i][j] * ri;
+            }
+            EXPECT_NEAR(dot, 0.0, 1e-10);
+        }
+    }
+    QR<double> rankDeficient{Matrix<double>{{1.0, 0.0}, {2.0, 0.0}, {3.0, 0.0}}};
+    EXPECT_FALSE(rankDeficient.fullRank());
+    EXPECT_THROW(rankDeficient.solve({1.0, 2.0, 3.0}), std::runtime_error);
+}
+
+TEST(UnitTestLayoutMatrix, layouts) {
+    using Morton = MortonLayout<8U>;
+    Matrix<long long> a = randomMatrix(21, 35, 1, -9LL, 9LL);
+    Matrix<long long> b = randomMatrix(35, 17, 2, -9LL, 9LL);
+    Matrix<long long> c = randomMatrix(21, 35, 3, -9LL, 9LL);
+    Matrix<long long> product = a * b;
+    Matrix<long long> sum = a + c;
+
+    LayoutMatrix<long long> rowA{a};
+    LayoutMatrix<long long, ColMajorLayout> colA{a};
+    LayoutMatrix<long long, Morton> mortonA{a};
+    EXPECT_TRUE(rowA == colA);
+    EXPECT_TRUE(colA == mortonA);
+    EXPECT_EQ(mortonA(20, 34), a[20][34]);
+    EXPECT_EQ(colA.toMatrix(), a);
+    EXPECT_EQ(LayoutMatrix<long long>{mortonA}.toMatrix(), a);
+
+    EXPECT_EQ((rowA * LayoutMatrix<long long>{b}).toMatrix(), product);
+    EXPECT_EQ((colA * LayoutMatrix<long long, ColMajorLayout>{b}).toMatrix(), product);
+    EXPECT_EQ((mortonA * LayoutMatrix<long long, Morton>{b}).toMatrix(), product);
+    EXPECT_EQ((colA * LayoutMatrix<long long, Morton>{b}).toMatrix(), product);
+    EXPECT_EQ((mortonA + LayoutMatrix<long long>{c}).toMatrix(), sum);
+    EXPECT_EQ((colA - LayoutMatrix<long long, Morton>{c}).toMatrix(), a - c);
+    EXPECT_EQ((mortonA * 3LL).toMatrix(), a * 3LL);
+    EXPECT_THROW(rowA * rowA, std::logic_error);
+
+    Matrix<long long> square = randomMatrix(30, 30, 4, -9LL, 9LL);
+    LayoutMatrix<long long, Morton> mortonSquare{square};
+    LayoutMatrix<long long, ColMajorLayout> colSquare{square};
+    mortonSquare.transpose();
+    colSquare.transpose();
+    mortonA.transpose();
+    Matrix<long long> transposed = square;
+    transposed.transpose();
+    EXPECT_EQ(mortonSquare.toMatrix(), transposed);
+    EXPECT_EQ(colSquare.toMatrix(), transposed);
+    EXPECT_EQ(mortonA.rows(), 35U);
+    EXPECT_EQ(mortonA.toMatrix(), Matrix<long long>{a}.transpose());
+
+    //LU on Morton tiles: a partial edge tile, PA = LU and det against Matrix
+    Matrix<double> m = randomMatrix(45, 45, 5, -1.0, 1.0);
+    LayoutMatrix<double, Morton> mortonM{m};
+    EXPECT_NEAR(mortonM.det(), m.detGauss(), 1e-10 * std::abs(m.detGauss()));
+    std::vector<size_t> pivots = mortonM.factorizeLU();
+    Matrix<double> l{45, 45};
+    Matrix<double> u{45, 45};
+    for (size_t i = 0; i < 45; ++i) {
+        for (size_t j = 0; j < 45; ++j) {
+            (j < i ? l[i][j] : u[i][j]) = mortonM(i, j);
+        }
+        l[i][i] = 1.0;
+    }
+    Matrix<double> pa = m;
+    for (size_t g = 0; g < 45; ++g) {
+        for (size_t j = 0; j < 45; ++j) {
+            std::swap(pa[g][j], pa[pivots[g]][j]);
+        }
+    }
+    Matrix<double> lu = l * u;
+    for (size_t i = 0; i < 45; ++i) {
+        for (size_t j = 0; j < 45; ++j) {
+            EXPECT_NEAR(lu[i][j], pa[i][j], 1e-12);
+        }
+    }
+    LayoutMatrix<double, Morton> singular{Matrix<double>{{1.0, 2.0}, {2.0, 4.0}}};
+    EXPECT_EQ(singular.det(), 0.0);
+    EXPECT_THROW((LayoutMatrix<double, Morton>{3, 4}.factorizeLU()), std::logic_error);
+}
+
+TEST(UnitTestExact, modInt) {
+    using Mod = ModInt<998244353U>;
+    Mod a{-1};
+    EXPECT_EQ(a.value(), 998244352U);
+    EXPECT_EQ((a * a).value(), 1U);
+    EXPECT_EQ((Mod{3} / Mod{3}).value(), 1U);
+    EXPECT_EQ((Mod{2}.pow(30) - Mod{1LL << 30}).value(), 0U);
+    EXPECT_EQ((Mod{5} * Mod{7}.inv() * Mod{7}).value(), 5U);
+    EXPECT_THROW(Mod{0}.inv(), std::domain_error);
+    EXPECT_TRUE(isZero(Mod{998244353LL}));
+
+    std::vector<long long> dstValues = randomVector(37, 1, 0LL, 998244352LL);
+    std::vector<long long> srcValues = randomVector(37, 2, 0LL, 998244352LL);
+    std::vector<Mod> dst(37);
+    std::vector<Mod> src(37);
+    std::vector<Mod> expected(37);
+    Mod coef{123456789};
+    for (size_t j = 0; j < 37; ++j) {
+        dst[j] = Mod{dstValues[j]};
+        src[j] = Mod{srcValues[j]};
+        expected[j] = dst[j] - coef * src[j];
+    }
+    Mod::subMul(dst.data(), src.data(), coef, 37);
+    EXPECT_EQ(dst, expected);
+
+    for (size_t n: {1U, 6U, 40U}) {
+        Matrix<long long> mtx = randomMatrix(n, n, n, -9LL, 9LL);
+        Matrix<Mod> mod{n, n};
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                mod[i][j] = Mod{mtx[i][j]};
+            }
+        }
+        if (n <= 6U) {
+            EXPECT_EQ(mod.det(), Mod{mtx.det()});
+        }
+        EXPECT_EQ(mod.det(), mod.detBareiss());
+        Matrix<long long> square = mtx * mtx;
+        Matrix<Mod> modSquare = mod * mod;
+        EXPECT_EQ(modSquare[n - 1][0], Mod{square[n - 1][0]});
+    }
+    EXPECT_EQ((Matrix<ModInt<7U>>{{1, 2}, {2, 4}}.det()), ModInt<7U>{0});
+}
+
+TEST(UnitTestExact, rational) {
+    Rational half{1, 2};
+    Rational third{-2, -6};
+    EXPECT_EQ(half + third, Rational(5, 6));
+    EXPECT_EQ(half - third, Rational(1, 6));
+    EXPECT_EQ(half * third, Rational(1, 6));
+    EXPECT_EQ(half / third, Rational(3, 2));
+    EXPECT_EQ(Rational(4, -8), -half);
+    EXPECT_TRUE(third < half);
+    EXPECT_EQ(static_cast<double>(half), 0.5);
+    EXPECT_THROW(half / Rational{0}, std::domain_error);
+    EXPECT_THROW(Rational(1, 0), std::domain_error);
+    EXPECT_THROW(Rational(1LL << 62) * Rational{4}, std::overflow_error);
+    std::stringstream ss;
+    ss << third << ' ' << Rational{7};
+    EXPECT_EQ(ss.str(), "1/3 7");
+
+    //det of the Hilbert matrix is 1 / prod of binomials, exact with rationals
+    Matrix<Rational> hilbert{5, 5};
+    for (size_t i = 0; i < 5; ++i) {
+        for (size_t j = 0; j < 5; ++j) {
+            hilbert[i][j] = Rational(1, static_cast<long long>(i + j + 1U));
+        }
+    }
+    EXPECT_EQ(hilbert.det(), Rational(1, 266716800000LL));
+    Matrix<Rational> singular{{Rational(1, 2), Rational(1, 3)}, {Rational(3, 2), Rational{1}}};
+    EXPECT_TRUE(isZero(singular.det()));
+    EXPECT_EQ((Matrix<Rational>{{1, 2}, {3, 4}}.det()), Rational{-2});
+}
+
+TEST(MatrixDetTest, multiModular) {
+    Matrix<int> m1{{2, -3, 1}, {2, 0, -1}, {1, 4, 5}};
+    EXPECT_EQ(m1.det(), 49);
+
+    Matrix<long long> m2{{0, 1}, {1, 0}};
+    EXPECT_EQ(m2.det(), -1);
+
+    Matrix<int> m3{{1, 2}, {2, 4}};
+    EXPECT_EQ(m3.det(), 0);
+
+    //L^T (3I) L with L unit upper triangular, det = 3^n
+    auto scaledGram = [] (size_t n) {
+        Matrix<long long> l = Matrix<long long>::eye(n, 1);
+        for (size_t i = 0; i + 1 < n; ++i) {
+            l[i][i + 1] = static_cast<long long>(i % 7) - 3;
+        }
+        Matrix<long long> res = Matrix<long long>::eye(n, 3) * l;
+        l.transpose();
+        return Matrix<long long>{l * res};
+    };
+    auto pow3 = [] (size_t n) {
+        long long res = 1;
+        for (size_t i = 0; i < n; ++i) {
+            res *= 3;
+        }
+        return res;
+    };
+
+    //det = 3^30 fits in long long, but Bareiss products a_kk a_ij overflow it, they need __int128
+    Matrix<long long> m4 = scaledGram(30);
+    EXPECT_EQ(m4.det(), pow3(30));
+    EXPECT_EQ(m4.detBareiss(), pow3(30));
+
+    //|det| = 3^39 > 2^61 is more than one symmetric digit modulo a prime below 2^62,
+    //Garner's reconstruction needs two
+    Matrix<long long> m5 = scaledGram(39);
+    EXPECT_EQ(m5.det(), pow3(39));
+    for (size_t j = 0; j < m5.cols(); ++j) {
+        m5[0][j] = -m5[0][j];
+    }
+    EXPECT_EQ(m5.det(), -pow3(39));
+
+    Matrix<long long> m6 = Matrix<long long>::eye(39, 3);
+    m6[0][0] = 9;
+    EXPECT_THROW(m6.det(), std::overflow_error);
+
+    Matrix<int> m7 = Matrix<int>::eye(3, 10000);
+    EXPECT_THROW(m7.det(), std::overflow_error);
+
+    //determinants of any size as decimal strings
+    EXPECT_EQ(m6.detDecimal(), "12157665459056928801");
+    EXPECT_EQ(m5.detDecimal(), "-" + std::to_string(pow3(39)));
+    EXPECT_EQ(m4.detDecimal(), std::to_string(pow3(30)));
+    EXPECT_EQ(m7.detDecimal(), "1000000000000");
+    EXPECT_EQ(m3.detDecimal(), "0");
+    EXPECT_EQ((Matrix<int>{{1, 2}, {0, 0}}).detDecimal(), "0");
+    EXPECT_EQ(scaledGram(200).detDecimal(), "265613988875874769338781322035779626829233452653394495974574961739092490901302182994384699044001");
+    //entries of an LCG in [-9, 9], det checked with exact rational elimination
+    Matrix<int> m8{40, 40};
+    std::uint64_t state = 1U;
+    for (size_t i = 0; i < 40; ++i) {
+        for (size_t j = 0; j < 40; ++j) {
+            state = (state * 1103515245U + 12345U) % (1U << 31U);
+            m8[i][j] = static_cast<int>((state >> 16U) % 19U) - 9;
+        }
+    }
+    EXPECT_EQ(m8.detDecimal(), "-615767366117841013036576366782532239891195912504974");
+}
+
+TEST(UnitTestMatrixIO, text) {
+    std::stringstream ss1{"2 3\n 1 -2.5 +3\n4e1 5 6"};
+    size_t m = 0;
+    size_t n = 0;
+    ss1 >> m >> n;
+    Matrix<double> m1{m, n};
+    ss1 >> m1;
+    EXPECT_TRUE(ss1);
+    EXPECT_TRUE(m1 == Matrix<double>({{1, -2.5, 3}, {40, 5, 6}}));
+
+    std::stringstream ss2{"1 2 3"};
+    Matrix<int> m2{2, 2};
+    ss2 >> m2;
+    EXPECT_FALSE(ss2);
+
+    std::string big = "300\n";
+    for (int i = 0; i < 300 * 300; ++i) {
+        big += std::to_string(i % 1000 - 500) + ((i % 300 == 299) ? "\n" : " ");
+    }
+    std::stringstream ss3{big};
+    BlockReader reader{ss3};
+    size_t size = reader.next<size_t>();
+    Matrix<int> m3{size, size, uninitialized};
+    reader.read(m3);
+    EXPECT_EQ(m3[0][0], -500);
+    EXPECT_EQ(m3[299][299], (300 * 300 - 1) % 1000 - 500);
+    EXPECT_THROW(reader.next<int>(), std::runtime_error);
+
+    std::string longToken = "0." + std::string(200, '1');
+    std::stringstream ss4{"1 1\n" + longToken};
+    ss4 >> m >> n;
+    Matrix<double> m4{m, n};
+    EXPECT_THROW(ss4 >> m4, std::runtime_error);
+
+    std::string blocks = "0." + std::string(70000, '1') + " 1";
+    std::stringstream ss5{blocks};
+    BlockReader reader5{ss5};
+    EXPECT_THROW(reader5.next<double>(), std::runtime_error);
+}
+
+TEST(UnitTestMatrixIO, binary) {
+    std::string path = std::filesystem::temp_directory_path() / "matrix_io_test.bin";
+    Matrix<double> m1{{1.5, 2, 3}, {4, 5, -6}};
+    writeBinary(path, m1);
+    EXPECT_TRUE(isBinaryFile(path));
+
+    MappedMatrix<double> mapped{path};
+    EXPECT_EQ(mapped.rows(), 2U);
+    EXPECT_EQ(mapped.cols(), 3U);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(mapped.data()) % cacheLineSize, 0U);
+    EXPECT_EQ(mapped.at(1, 2), -6.0);
+    EXPECT_TRUE(mapped.toMatrix() == m1);
+    EXPECT_THROW(MappedMatrix<float>{path}, std::runtime_error);
+
+    EXPECT_TRUE(Matrix<double>{mapped.view()} == m1);
+    EXPECT_TRUE(::matrix::equals(det(mapped.view().block(0, 0, 2, 2)), -0.5));
+
+    Matrix<float> m2 = readBinary<float>(path);
+    EXPECT_EQ(m2[0][0], 1.5f);
+
+    //rows * cols * sizeof(double) wraps around to a small number
+    BinaryHeader header;
+    header.rows = 1ULL << 61U;
+    header.cols = 8U;
+    {
+        std::fstream file{path, std::ios::in | std::ios::out | std::ios::binary};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    EXPECT_THROW(MappedMatrix<double>{path}, std::runtime_error);
+    EXPECT_THROW(readBinary<double>(path), std::runtime_error);
+    std::filesystem::remove(path);
+}
+
+TEST(MatrixDetTest, parallelBareiss) {
+    for (size_t n: {1U, 2U, 7U, 12U, 70U}) {
+        Matrix<long long> m1 = randomMatrix(n, n, 2 * n, -2LL, 2LL);
+        //unit upper triangular, so the determinant is 1
+        Matrix<int> m2 = randomMatrix(n, n, 2 * n + 1, 0, 1);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j <= i; ++j) {
+                m2[i][j] = i == j ? 1 : 0;
+            }
+        }
+        if (n < 70U) {
+            EXPECT_EQ(m1.detBareiss(), m1.det());
+        }
+        EXPECT_EQ(m2.detBareiss(), 1);
+    }
+    Matrix<int> m3{{0, 2, 1}, {3, 0, 0}, {0, 0, 4}};
+    EXPECT_EQ(m3.detBareiss(), -24);
+    EXPECT_EQ(m3.detBareiss(), m3.det());
+    EXPECT_EQ((Matrix<int>{{1, 2}, {2, 4}}).detBareiss(), 0);
+    EXPECT_THROW(Matrix<int>::eye(40, 1 << 20).detBareiss(), std::overflow_error);
+    //the pivot swap negates min(): every intermediate fits, the determinant doesn't
+    constexpr int intMin = std::numeric_limits<int>::min();
+    EXPECT_THROW((Matrix<int>{{0, 1}, {intMin, 0}}).detBareiss(), std::overflow_error);
+    EXPECT_EQ((Matrix<int>{{0, 1}, {intMin + 1, 0}}).detBareiss(), std::numeric_limits<int>::max());
+}
+
 TEST(MatrixDetTest, end2endTest) {
     namespace fs = std::filesystem;
     std::string inputPath = "../tests/";
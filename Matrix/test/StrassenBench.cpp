@@ -0,0 +1,69 @@
+#include <chrono>
+#include <random>
+#include <string>
+#include <iostream>
+#include "../include/Matrix.hpp"
+
+using namespace matrix;
+
+//Usage: strassen_bench [maxN]. Compares blocked gemm with Strassen-Winograd at
+//several cutoffs and prints the first size where Strassen wins.
+namespace {
+
+template<typename F>
+double seconds(F func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+Matrix<double> random(size_t n, std::mt19937& gen) {
+    std::uniform_real_distribution<double> dist{-1.0, 1.0};
+    Matrix<double> res{n, n, uninitialized};
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            res[i][j] = dist(gen);
+        }
+    }
+    return res;
+}
+
+} //namespace
+
+int main(int argc, char** argv) {
+    size_t maxN = argc > 1 ? std::stoul(argv[1]) : 2048U;
+    std::mt19937 gen{2024};
+    size_t crossover = 0U;
+    //strassen is serial while gemm uses the pool: the crossover holds for this many threads
+    std::cout << "threads: " << ThreadPool::instance().size() << std::endl;
+    std::cout << "n\tgemm, s\tcutoff\tstrassen, s\tmax error" << std::endl;
+    for (size_t n = 256U; n <= maxN; n *= 2U) {
+        Matrix<double> lhs{random(n, gen)};
+        Matrix<double> rhs{random(n, gen)};
+        Matrix<double> classic{n, n};
+        double gemmTime = seconds([&] { gemm<double>(lhs.view(), rhs.view(), classic.view()); });
+        double best = gemmTime;
+        for (size_t cutoff = 64U; cutoff < n; cutoff *= 2U) {
+            Matrix<double> fast{n, n, uninitialized};
+            Arena<double> arena{strassenWorkspace(n, cutoff)};
+            double time = seconds([&] { strassen<double>(lhs.view(), rhs.view(), fast.view(), arena, cutoff); });
+            double maxError = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t j = 0; j < n; ++j) {
+                    maxError = std::max(maxError, std::abs(fast[i][j] - classic[i][j]));
+                }
+            }
+            std::cout << n << '\t' << gemmTime << '\t' << cutoff << '\t' << time << '\t' << maxError << std::endl;
+            best = std::min(best, time);
+        }
+        if (crossover == 0U && best < gemmTime) {
+            crossover = n;
+        }
+    }
+    if (crossover != 0U) {
+        std::cout << "Strassen is faster from n = " << crossover << std::endl;
+    } else {
+        std::cout << "Strassen isn't faster up to n = " << maxN << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,792 @@
+#pragma once
+
+/*
+Class BPTree. Counted B+-tree with the interface of RBTree (see Tree.hpp), for sets of
+10^7 keys and more, where a binary tree spends its time waiting for the cache.
+Nodes take about bpNodeBytes. Leaves hold sorted keys and make a list, inner nodes hold
+separators, children and the number of keys under every child, so rank and select are
+one root-to-leaf descent. For arithmetic keys with std::less the search inside a node
+is a branchless count over the whole key array, which the compiler turns into SIMD
+compares; other keys are binary searched.
+
+Class BPIterator. A leaf and a position in it, insert and erase invalidate iterators.
+
+Functionality of BPTree:
+    begin(), end(), rbegin(), rend()
+    empty() - check whether tree is filled with something
+    size() - returns number of the keys in the tree
+    height() - number of levels, leaves included
+    root() - returns constant pointer to the root node
+    clear() - delete every key from the tree
+    memory() - bytes of node storage held by the allocators
+    insert(const key_type& key) - iterator to the key, inserted or already present
+    erase(const key_type& key) - iterator to the key after the erased one, end() if there was none
+    find(const key_type& key) - returns iterator to the found key or end()
+    lower_bound(const key_type& key) - iterator to the first key not less than key
+    upper_bound(const key_type& key) - iterator to the first key greater than key
+    distance(iterator first, iterator last) - returns number of keys in the range
+    select(size_t k) - iterator to the k-th smallest key (from 0), end() if k >= size()
+    rank(const key_type& key) - number of keys less than key
+    count_range(const key_type& lo, const key_type& hi) - number of keys in [lo, hi]
+*/
+
+#include <array>
+#include <tuple>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include "NodeArena.hpp"
+
+namespace tree {
+
+inline constexpr size_t bpNodeBytes = 512U;
+
+struct BPHeader
+{
+    std::uint32_t count_ = 0U; //keys in a leaf, children in an inner node
+    bool leaf_ = true;
+};
+
+//Slots that fit in a node beside fixedBytes, rounded down to whole 32-byte vectors of keys.
+template<typename K>
+constexpr size_t bpSlots(size_t fixedBytes, size_t slotBytes) {
+    size_t lanes = sizeof(K) < 32U ? 32U / sizeof(K) : 1U;
+    size_t slots = fixedBytes < bpNodeBytes ? (bpNodeBytes - fixedBytes) / slotBytes / lanes * lanes : 0U;
+    return std::max<size_t>(slots, 4U);
+}
+
+//One slot more than capacity, so that a key is inserted first and the leaf is split after.
+template<typename K>
+struct BPLeaf final: BPHeader
+{
+    static constexpr size_t slots = bpSlots<K>(sizeof(BPHeader) + 2U * sizeof(void*), sizeof(K));
+    static constexpr size_t capacity = slots - 1U;
+
+    std::array<K, slots> keys_{};
+    BPLeaf* prev_ = nullptr;
+    BPLeaf* next_ = nullptr;
+};
+
+//Child i holds the keys in [keys_[i - 1], keys_[i]). capacity counts children, the
+//arrays have room for one more.
+template<typename K>
+struct BPInner final: BPHeader
+{
+    static constexpr size_t slots = bpSlots<K>(sizeof(BPHeader) + sizeof(void*) + sizeof(size_t),
+                                               sizeof(K) + sizeof(void*) + sizeof(size_t));
+    static constexpr size_t capacity = slots;
+
+    std::array<K, slots> keys_{};
+    std::array<BPHeader*, slots + 1U> children_{};
+    std::array<size_t, slots + 1U> counts_{};
+
+    BPInner() {
+        leaf_ = false;
+    }
+};
+
+template<typename K>
+struct BPIterator final
+{
+    using Leaf = BPLeaf<K>;
+
+    using iterator_category = std::bidirectional_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = K;
+    using pointer = const K*;
+    using reference = const K&;
+
+    BPIterator() {}
+
+    BPIterator(Leaf* leaf, size_t pos):
+        leaf_(leaf), pos_(pos) {}
+
+    reference operator*() const {
+        return leaf_->keys_[pos_];
+    }
+
+    pointer operator->() const {
+        return std::addressof(leaf_->keys_[pos_]);
+    }
+
+    BPIterator& operator++() {
+        if (++pos_ == leaf_->count_) {
+            leaf_ = leaf_->next_;
+            pos_ = 0U;
+        }
+        return *this;
+    }
+
+    BPIterator operator++(int) {
+        BPIterator me = *this;
+        ++*this;
+        return me;
+    }
+
+    BPIterator& operator--() {
+        if (pos_ == 0U) {
+            leaf_ = leaf_->prev_;
+            pos_ = leaf_->count_;
+        }
+        --pos_;
+        return *this;
+    }
+
+    BPIterator operator--(int) {
+        BPIterator me = *this;
+        --*this;
+        return me;
+    }
+
+    bool operator==(const BPIterator& rhs) const = default;
+
+    Leaf* leaf_ = nullptr;
+    size_t pos_ = 0U;
+};
+
+template<typename K, class Compare = std::less<K>>
+class BPTree final
+{
+public:
+    using Leaf = BPLeaf<K>;
+    using Inner = BPInner<K>;
+
+    using value_type = K;
+    using pointer = const K*;
+    using reference = const K&;
+
+    using iterator = BPIterator<K>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+
+private:
+    static constexpr bool simdSearch = std::is_arithmetic_v<K> && std::is_same_v<Compare, std::less<K>>;
+    static constexpr size_t maxHeight = 8U * sizeof(size_t);
+
+    struct Path
+    {
+        std::array<Inner*, maxHeight> nodes;
+        std::array<size_t, maxHeight> slots;
+        size_t depth = 0U;
+    };
+
+    Leaf headLeaf_ = Leaf{}; //sentinel of the leaf list, end() points to it
+    Leaf* head_ = std::addressof(headLeaf_);
+    BPHeader* root_ = nullptr;
+    size_t size_ = 0U;
+    size_t height_ = 0U;
+
+    NodeArena<Leaf> leaves_;
+    NodeArena<Inner> inners_;
+    Compare compare_;
+
+    static Leaf* asLeaf(BPHeader* node) {
+        return static_cast<Leaf*>(node);
+    }
+
+    static const Leaf* asLeaf(const BPHeader* node) {
+        return static_cast<const Leaf*>(node);
+    }
+
+    static Inner* asInner(BPHeader* node) {
+        return static_cast<Inner*>(node);
+    }
+
+    static const Inner* asInner(const BPHeader* node) {
+        return static_cast<const Inner*>(node);
+    }
+
+    static size_t minCount(const BPHeader* node) {
+        return node->leaf_ ? Leaf::capacity / 2U : (Inner::capacity + 1U) / 2U;
+    }
+
+    void headInit() {
+        head_->prev_ = head_;
+        head_->next_ = head_;
+        head_->count_ = 0U;
+    }
+
+    static void linkAfter(Leaf* prev, Leaf* leaf) {
+        leaf->prev_ = prev;
+        leaf->next_ = prev->next_;
+        prev->next_->prev_ = leaf;
+        prev->next_ = leaf;
+    }
+
+    static void unlink(Leaf* leaf) {
+        leaf->prev_->next_ = leaf->next_;
+        leaf->next_->prev_ = leaf->prev_;
+    }
+
+    //Number of the first n keys that are less than key (Upper: not greater than key).
+    template<bool Upper, size_t N>
+    size_t position(const std::array<K, N>& keys, size_t n, const K& key) const {
+        if constexpr (simdSearch) {
+            std::uint32_t res = 0U;
+            std::uint32_t last = static_cast<std::uint32_t>(n);
+            for (std::uint32_t i = 0; i < N; ++i) {
+                bool before = Upper ? !(key < keys[i]) : keys[i] < key;
+                res += static_cast<std::uint32_t>(i < last) & static_cast<std::uint32_t>(before);
+            }
+            return res;
+        } else {
+            auto first = keys.begin();
+            if constexpr (Upper) {
+                return std::upper_bound(first, first + n, key, compare_) - first;
+            } else {
+                return std::lower_bound(first, first + n, key, compare_) - first;
+            }
+        }
+    }
+
+    //The child of an inner node whose range holds key.
+    size_t childFor(const Inner* inner, const K& key) const {
+        return position<true>(inner->keys_, inner->count_ - 1U, key);
+    }
+
+    Leaf* leafFor(const K& key) const {
+        BPHeader* node = root_;
+        while (!node->leaf_) {
+            const Inner* inner = asInner(node);
+            node = inner->children_[childFor(inner, key)];
+        }
+        return asLeaf(node);
+    }
+
+    Leaf* descend(const K& key, Path& path) const {
+        BPHeader* node = root_;
+        path.depth = 0U;
+        while (!node->leaf_) {
+            Inner* inner = asInner(node);
+            size_t child = childFor(inner, key);
+            path.nodes[path.depth] = inner;
+            path.slots[path.depth] = child;
+            path.depth++;
+            node = inner->children_[child];
+        }
+        return asLeaf(node);
+    }
+
+    //An iterator past the last key of a leaf is moved to the next leaf.
+    iterator normalize(Leaf* leaf, size_t pos) const {
+        return pos < leaf->count_ ? iterator(leaf, pos) : iterator(leaf->next_, 0U);
+    }
+
+    //Number of keys less than key (Upper: not greater than key).
+    template<bool Upper>
+    size_t countBefore(const K& key) const {
+        if (!root_) {
+            return 0U;
+        }
+        size_t res = 0U;
+        const BPHeader* node = root_;
+        while (!node->leaf_) {
+            const Inner* inner = asInner(node);
+            size_t child = childFor(inner, key);
+            for (size_t i = 0; i < child; ++i) {
+                res += inner->counts_[i];
+            }
+            node = inner->children_[child];
+        }
+        const Leaf* leaf = asLeaf(node);
+        return res + position<Upper>(leaf->keys_, leaf->count_, key);
+    }
+
+    size_t rankOf(iterator it) const {
+        return it.leaf_ == head_ ? size_ : countBefore<false>(*it);
+    }
+
+    //Moves the upper half of an overflowed leaf to a new one after it.
+    Leaf* splitLeaf(Leaf* leaf) {
+        Leaf* right = leaves_.create();
+        size_t half = leaf->count_ / 2U;
+        std::move(leaf->keys_.begin() + half, leaf->keys_.begin() + leaf->count_, right->keys_.begin());
+        right->count_ = leaf->count_ - half;
+        leaf->count_ = half;
+        linkAfter(leaf, right);
+        return right;
+    }
+
+    //Moves the upper half of an overflowed inner node to a new one, returns it with
+    //the separator going up and the number of keys under it.
+    std::tuple<K, Inner*, size_t> splitInner(Inner* inner) {
+        Inner* right = inners_.create();
+        size_t n = inner->count_;
+        size_t half = n / 2U;
+        K sep = inner->keys_[half - 1U];
+        std::move(inner->keys_.begin() + half, inner->keys_.begin() + n - 1U, right->keys_.begin());
+        std::copy(inner->children_.begin() + half, inner->children_.begin() + n, right->children_.begin());
+        std::copy(inner->counts_.begin() + half, inner->counts_.begin() + n, right->counts_.begin());
+        size_t moved = 0U;
+        for (size_t i = half; i < n; ++i) {
+            moved += inner->counts_[i];
+        }
+        right->count_ = n - half;
+        inner->count_ = half;
+        return {sep, right, moved};
+    }
+
+    //Puts right, split off the node at the given level of the path, next to it in the
+    //parent; splits overflowed parents up to a new root.
+    void insertSplit(Path& path, size_t level, K sep, BPHeader* right, size_t rightCount) {
+        while (level > 0U) {
+            Inner* parent = path.nodes[level - 1U];
+            size_t slot = path.slots[level - 1U];
+            size_t n = parent->count_;
+            std::move_backward(parent->keys_.begin() + slot, parent->keys_.begin() + n - 1U,
+                               parent->keys_.begin() + n);
+            std::copy_backward(parent->children_.begin() + slot + 1U, parent->children_.begin() + n,
+                               parent->children_.begin() + n + 1U);
+            std::copy_backward(parent->counts_.begin() + slot + 1U, parent->counts_.begin() + n,
+                               parent->counts_.begin() + n + 1U);
+            parent->keys_[slot] = std::move(sep);
+            parent->children_[slot + 1U] = right;
+            parent->counts_[slot + 1U] = rightCount;
+            parent->counts_[slot] -= rightCount;
+            parent->count_++;
+            if (parent->count_ <= Inner::capacity) {
+                return;
+            }
+            auto [upSep, upRight, upCount] = splitInner(parent);
+            sep = std::move(upSep);
+            right = upRight;
+            rightCount = upCount;
+            level--;
+        }
+        Inner* root = inners_.create();
+        root->keys_[0] = std::move(sep);
+        root->children_[0] = root_;
+        root->children_[1] = right;
+        root->counts_[0] = size_ - rightCount;
+        root->counts_[1] = rightCount;
+        root->count_ = 2U;
+        root_ = root;
+        height_++;
+    }
+
+    iterator insertImpl(const K& key) {
+        if (!root_) {
+            Leaf* leaf = leaves_.create();
+            leaf->keys_[0] = key;
+            leaf->count_ = 1U;
+            linkAfter(head_, leaf);
+            root_ = leaf;
+            size_ = 1U;
+            height_ = 1U;
+            return iterator(leaf, 0U);
+        }
+        Path path;
+        Leaf* leaf = descend(key, path);
+        size_t pos = position<false>(leaf->keys_, leaf->count_, key);
+        if (pos < leaf->count_ && !compare_(key, leaf->keys_[pos])) {
+            return iterator(leaf, pos);
+        }
+        for (size_t level = 0; level < path.depth; ++level) {
+            path.nodes[level]->counts_[path.slots[level]]++;
+        }
+        std::move_backward(leaf->keys_.begin() + pos, leaf->keys_.begin() + leaf->count_,
+                           leaf->keys_.begin() + leaf->count_ + 1U);
+        leaf->keys_[pos] = key;
+        leaf->count_++;
+        size_++;
+        if (leaf->count_ <= Leaf::capacity) {
+            return iterator(leaf, pos);
+        }
+        Leaf* right = splitLeaf(leaf);
+        iterator res = pos < leaf->count_ ? iterator(leaf, pos) : iterator(right, pos - leaf->count_);
+        insertSplit(path, path.depth, right->keys_[0], right, right->count_);
+        return res;
+    }
+
+    void borrowFromLeft(Inner* parent, size_t slot) {
+        BPHeader* node = parent->children_[slot];
+        BPHeader* left = parent->children_[slot - 1U];
+        size_t moved = 1U;
+        if (node->leaf_) {
+            Leaf* to = asLeaf(node);
+            Leaf* from = asLeaf(left);
+            std::move_backward(to->keys_.begin(), to->keys_.begin() + to->count_,
+                               to->keys_.begin() + to->count_ + 1U);
+            to->keys_[0] = std::move(from->keys_[from->count_ - 1U]);
+            parent->keys_[slot - 1U] = to->keys_[0];
+        } else {
+            Inner* to = asInner(node);
+            Inner* from = asInner(left);
+            size_t n = to->count_;
+            size_t last = from->count_ - 1U;
+            std::move_backward(to->keys_.begin(), to->keys_.begin() + n - 1U, to->keys_.begin() + n);
+            std::copy_backward(to->children_.begin(), to->children_.begin() + n, to->children_.begin() + n + 1U);
+            std::copy_backward(to->counts_.begin(), to->counts_.begin() + n, to->counts_.begin() + n + 1U);
+            to->keys_[0] = std::move(parent->keys_[slot - 1U]);
+            to->children_[0] = from->children_[last];
+            to->counts_[0] = from->counts_[last];
+            parent->keys_[slot - 1U] = std::move(from->keys_[last - 1U]);
+            moved = from->counts_[last];
+        }
+        left->count_--;
+        node->count_++;
+        parent->counts_[slot - 1U] -= moved;
+        parent->counts_[slot] += moved;
+    }
+
+    void borrowFromRight(Inner* parent, size_t slot) {
+        BPHeader* node = parent->children_[slot];
+        BPHeader* right = parent->children_[slot + 1U];
+        size_t moved = 1U;
+        if (node->leaf_) {
+            Leaf* to = asLeaf(node);
+            Leaf* from = asLeaf(right);
+            to->keys_[to->count_] = std::move(from->keys_[0]);
+            std::move(from->keys_.begin() + 1U, from->keys_.begin() + from->count_, from->keys_.begin());
+            parent->keys_[slot] = from->keys_[0];
+        } else {
+            Inner* to = asInner(node);
+            Inner* from = asInner(right);
+            size_t n = to->count_;
+            size_t m = from->count_;
+            to->keys_[n - 1U] = std::move(parent->keys_[slot]);
+            to->children_[n] = from->children_[0];
+            to->counts_[n] = from->counts_[0];
+            parent->keys_[slot] = std::move(from->keys_[0]);
+            moved = from->counts_[0];
+            std::move(from->keys_.begin() + 1U, from->keys_.begin() + m - 1U, from->keys_.begin());
+            std::copy(from->children_.begin() + 1U, from->children_.begin() + m, from->children_.begin());
+            std::copy(from->counts_.begin() + 1U, from->counts_.begin() + m, from->counts_.begin());
+        }
+        right->count_--;
+        node->count_++;
+        parent->counts_[slot] += moved;
+        parent->counts_[slot + 1U] -= moved;
+    }
+
+    //Moves child slot + 1 of the parent into child slot and removes it.
+    void merge(Inner* parent, size_t slot) {
+        BPHeader* left = parent->children_[slot];
+        BPHeader* right = parent->children_[slot + 1U];
+        if (left->leaf_) {
+            Leaf* to = asLeaf(left);
+            Leaf* from = asLeaf(right);
+            std::move(from->keys_.begin(), from->keys_.begin() + from->count_, to->keys_.begin() + to->count_);
+            to->count_ += from->count_;
+            unlink(from);
+            leaves_.destroy(from);
+        } else {
+            Inner* to = asInner(left);
+            Inner* from = asInner(right);
+            size_t n = to->count_;
+            size_t m = from->count_;
+            to->keys_[n - 1U] = std::move(parent->keys_[slot]);
+            std::move(from->keys_.begin(), from->keys_.begin() + m - 1U, to->keys_.begin() + n);
+            std::copy(from->children_.begin(), from->children_.begin() + m, to->children_.begin() + n);
+            std::copy(from->counts_.begin(), from->counts_.begin() + m, to->counts_.begin() + n);
+            to->count_ += m;
+            inners_.destroy(from);
+        }
+        size_t n = parent->count_;
+        parent->counts_[slot] += parent->counts_[slot + 1U];
+        std::move(parent->keys_.begin() + slot + 1U, parent->keys_.begin() + n - 1U, parent->keys_.begin() + slot);
+        std::copy(parent->children_.begin() + slot + 2U, parent->children_.begin() + n,
+                  parent->children_.begin() + slot + 1U);
+        std::copy(parent->counts_.begin() + slot + 2U, parent->counts_.begin() + n,
+                  parent->counts_.begin() + slot + 1U);
+        parent->count_--;
+    }
+
+    //Refills underflowed nodes from the leaf of the path upwards: a sibling with spare
+    //keys lends one, otherwise two siblings merge and the parent loses a child.
+    void rebalance(Path& path, BPHeader* node) {
+        for (size_t level = path.depth; level > 0U && node->count_ < minCount(node); --level) {
+            Inner* parent = path.nodes[level - 1U];
+            size_t slot = path.slots[level - 1U];
+            if (slot > 0U && parent->children_[slot - 1U]->count_ > minCount(node)) {
+                borrowFromLeft(parent, slot);
+                return;
+            }
+            if (slot + 1U < parent->count_ && parent->children_[slot + 1U]->count_ > minCount(node)) {
+                borrowFromRight(parent, slot);
+                return;
+            }
+            merge(parent, slot > 0U ? slot - 1U : slot);
+            node = parent;
+        }
+        if (!root_->leaf_ && root_->count_ == 1U) {
+            Inner* root = asInner(root_);
+            root_ = root->children_[0];
+            inners_.destroy(root);
+            height_--;
+        }
+    }
+
+    iterator eraseImpl(const K& key) {
+        if (!root_) {
+            return end();
+        }
+        Path path;
+        Leaf* leaf = descend(key, path);
+        size_t pos = position<false>(leaf->keys_, leaf->count_, key);
+        if (pos == leaf->count_ || compare_(key, leaf->keys_[pos])) {
+            return end();
+        }
+        for (size_t level = 0; level < path.depth; ++level) {
+            path.nodes[level]->counts_[path.slots[level]]--;
+        }
+        std::move(leaf->keys_.begin() + pos + 1U, leaf->keys_.begin() + leaf->count_, leaf->keys_.begin() + pos);
+        leaf->count_--;
+        size_--;
+        if (!size_) {
+            unlink(leaf);
+            leaves_.destroy(leaf);
+            root_ = nullptr;
+            height_ = 0U;
+            return end();
+        }
+        iterator next = normalize(leaf, pos);
+        if (path.depth == 0U || leaf->count_ >= minCount(leaf)) {
+            return next;
+        }
+        if (next == end()) {
+            rebalance(path, leaf);
+            return end();
+        }
+        K nextKey = *next;
+        rebalance(path, leaf);
+        return lower_bound(nextKey);
+    }
+
+    BPHeader* cloneImpl(const BPHeader* src, Leaf*& last) {
+        if (src->leaf_) {
+            Leaf* leaf = leaves_.create(*asLeaf(src));
+            leaf->prev_ = last;
+            last->next_ = leaf;
+            last = leaf;
+            return leaf;
+        }
+        Inner* inner = inners_.create(*asInner(src));
+        for (size_t i = 0; i < inner->count_; ++i) {
+            inner->children_[i] = cloneImpl(inner->children_[i], last);
+        }
+        return inner;
+    }
+
+    void cloneFrom(const BPTree& rhs) {
+        if (!rhs.root_) {
+            return;
+        }
+        Leaf* last = head_;
+        root_ = cloneImpl(rhs.root_, last);
+        last->next_ = head_;
+        head_->prev_ = last;
+        size_ = rhs.size_;
+        height_ = rhs.height_;
+    }
+
+    void destroyImpl(BPHeader* node) {
+        if (node->leaf_) {
+            leaves_.destroy(asLeaf(node));
+            return;
+        }
+        Inner* inner = asInner(node);
+        for (size_t i = 0; i < inner->count_; ++i) {
+            destroyImpl(inner->children_[i]);
+        }
+        inners_.destroy(inner);
+    }
+
+    void deleteNodes() {
+        if constexpr (!std::is_trivially_destructible_v<K>) {
+            if (root_) {
+                destroyImpl(root_);
+            }
+        }
+        leaves_.clear();
+        inners_.clear();
+    }
+
+    //After the leaf lists were exchanged, their ends are redirected to our sentinel.
+    void relinkHead() {
+        if (!root_) {
+            headInit();
+            return;
+        }
+        head_->next_->prev_ = head_;
+        head_->prev_->next_ = head_;
+    }
+
+    void swapImpl(BPTree& rhs) noexcept {
+        std::swap(root_, rhs.root_);
+        std::swap(size_, rhs.size_);
+        std::swap(height_, rhs.height_);
+        std::swap(head_->prev_, rhs.head_->prev_);
+        std::swap(head_->next_, rhs.head_->next_);
+        leaves_.swap(rhs.leaves_);
+        inners_.swap(rhs.inners_);
+        std::swap(compare_, rhs.compare_);
+        relinkHead();
+        rhs.relinkHead();
+    }
+
+public:
+    BPTree() {
+        headInit();
+    }
+
+    BPTree(const BPTree& rhs):
+        compare_(rhs.compare_) {
+        headInit();
+        cloneFrom(rhs);
+    }
+
+    BPTree(BPTree&& rhs) noexcept {
+        headInit();
+        swapImpl(rhs);
+    }
+
+    BPTree& operator=(const BPTree& rhs) {
+        if (this != std::addressof(rhs)) {
+            BPTree copy{rhs};
+            swapImpl(copy);
+        }
+        return *this;
+    }
+
+    BPTree& operator=(BPTree&& rhs) noexcept {
+        if (this != std::addressof(rhs)) {
+            swapImpl(rhs);
+        }
+        return *this;
+    }
+
+    ~BPTree() {
+        deleteNodes();
+    }
+
+    void swap(BPTree& rhs) noexcept {
+        swapImpl(rhs);
+    }
+
+    iterator begin() const {
+        return iterator(head_->next_, 0U);
+    }
+
+    iterator end() const {
+        return iterator(head_, 0U);
+    }
+
+    reverse_iterator rbegin() const {
+        return reverse_iterator(end());
+    }
+
+    reverse_iterator rend() const {
+        return reverse_iterator(begin());
+    }
+
+    bool empty() const {
+        return !root_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    size_t height() const {
+        return height_;
+    }
+
+    const BPHeader* root() const {
+        return root_;
+    }
+
+    void clear() {
+        deleteNodes();
+        headInit();
+        root_ = nullptr;
+        size_ = 0U;
+        height_ = 0U;
+    }
+
+    size_t memory() const {
+        return leaves_.capacity() * sizeof(Leaf) + inners_.capacity() * sizeof(Inner);
+    }
+
+    bool operator==(const BPTree& rhs) const {
+        return size() == rhs.size() && std::equal(begin(), end(), rhs.begin());
+    }
+
+    bool operator!=(const BPTree& rhs) const {
+        return !(*this == rhs);
+    }
+
+    iterator insert(const K& key) {
+        return insertImpl(key);
+    }
+
+    iterator erase(const K& key) {
+        return eraseImpl(key);
+    }
+
+    iterator find(const K& key) const {
+        if (!root_) {
+            return end();
+        }
+        Leaf* leaf = leafFor(key);
+        size_t pos = position<false>(leaf->keys_, leaf->count_, key);
+        if (pos == leaf->count_ || compare_(key, leaf->keys_[pos])) {
+            return end();
+        }
+        return iterator(leaf, pos);
+    }
+
+    iterator lower_bound(const K& key) const {
+        if (!root_) {
+            return end();
+        }
+        Leaf* leaf = leafFor(key);
+        return normalize(leaf, position<false>(leaf->keys_, leaf->count_, key));
+    }
+
+    iterator upper_bound(const K& key) const {
+        if (!root_) {
+            return end();
+        }
+        Leaf* leaf = leafFor(key);
+        return normalize(leaf, position<true>(leaf->keys_, leaf->count_, key));
+    }
+
+    size_t distance(iterator first, iterator last) const {
+        size_t from = rankOf(first);
+        size_t to = rankOf(last);
+        return from < to ? to - from : 0U;
+    }
+
+    iterator select(size_t k) const {
+        if (k >= size_) {
+            return end();
+        }
+        BPHeader* node = root_;
+        while (!node->leaf_) {
+            const Inner* inner = asInner(node);
+            size_t child = 0U;
+            while (k >= inner->counts_[child]) {
+                k -= inner->counts_[child];
+                child++;
+            }
+            node = inner->children_[child];
+        }
+        return iterator(asLeaf(node), k);
+    }
+
+    size_t rank(const K& key) const {
+        return countBefore<false>(key);
+    }
+
+    size_t count_range(const K& lo, const K& hi) const {
+        if (compare_(hi, lo)) {
+            return 0U;
+        }
+        return countBefore<true>(hi) - countBefore<false>(lo);
+    }
+};
+
+} //namespace tree
@@ -0,0 +1,177 @@
+#pragma once
+
+/*
+Node allocator policies of RBTree.
+
+Class NodeArena<T>. Default policy. Nodes are placed in contiguous chunks, each chunk
+twice as big as the previous one (up to maxChunkNodes), so neighbouring inserts get
+neighbouring addresses and memory is about sizeof(T) per node. Destroyed nodes go to
+an intrusive free list threaded through their own storage and are reused first.
+Functionality:
+    create(args...) - constructs T in a free slot
+    destroy(ptr)    - destroys T and puts the slot to the free list
+    clear()         - releases all chunks at once, O(number of chunks); live objects
+                      must be trivially destructible or already destroyed
+    bulkRelease     - true: clear() frees live objects, the owner needn't destroy them
+    size()          - live objects
+    capacity()      - slots in all chunks
+    swap(other)
+
+Class HeapNodes<T>. new/delete per node, the same interface.
+*/
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+namespace tree {
+
+inline constexpr size_t minChunkNodes = 64U;
+inline constexpr size_t maxChunkNodes = 1U << 16U;
+
+template<typename T>
+class NodeArena final
+{
+    union Slot
+    {
+        Slot* next;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> chunks_;
+    Slot* free_ = nullptr;
+    Slot* bump_ = nullptr;
+    Slot* bumpEnd_ = nullptr;
+    size_t size_ = 0U;
+    size_t capacity_ = 0U;
+
+    Slot* allocate() {
+        if (free_) {
+            Slot* slot = free_;
+            free_ = slot->next;
+            return slot;
+        }
+        if (bump_ == bumpEnd_) {
+            size_t count = chunks_.empty() ? minChunkNodes : std::min(capacity_, maxChunkNodes);
+            chunks_.push_back(std::make_unique_for_overwrite<Slot[]>(count));
+            bump_ = chunks_.back().get();
+            bumpEnd_ = bump_ + count;
+            capacity_ += count;
+        }
+        return bump_++;
+    }
+
+public:
+    static constexpr bool bulkRelease = true;
+
+    NodeArena() = default;
+
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+    NodeArena(NodeArena&& rhs) noexcept {
+        swap(rhs);
+    }
+
+    NodeArena& operator=(NodeArena&& rhs) noexcept {
+        swap(rhs);
+        return *this;
+    }
+
+    template<typename... Args>
+    T* create(Args&&... args) {
+        Slot* slot = allocate();
+        T* res = ::new (static_cast<void*>(slot->storage)) T(std::forward<Args>(args)...);
+        size_++;
+        return res;
+    }
+
+    void destroy(T* ptr) {
+        std::destroy_at(ptr);
+        Slot* slot = reinterpret_cast<Slot*>(ptr);
+        slot->next = free_;
+        free_ = slot;
+        size_--;
+    }
+
+    void clear() {
+        chunks_.clear();
+        free_ = nullptr;
+        bump_ = nullptr;
+        bumpEnd_ = nullptr;
+        size_ = 0U;
+        capacity_ = 0U;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    void swap(NodeArena& rhs) noexcept {
+        std::swap(chunks_, rhs.chunks_);
+        std::swap(free_, rhs.free_);
+        std::swap(bump_, rhs.bump_);
+        std::swap(bumpEnd_, rhs.bumpEnd_);
+        std::swap(size_, rhs.size_);
+        std::swap(capacity_, rhs.capacity_);
+    }
+};
+
+template<typename T>
+class HeapNodes final
+{
+    size_t size_ = 0U;
+
+public:
+    static constexpr bool bulkRelease = false;
+
+    HeapNodes() = default;
+
+    HeapNodes(const HeapNodes&) = delete;
+    HeapNodes& operator=(const HeapNodes&) = delete;
+
+    HeapNodes(HeapNodes&& rhs) noexcept {
+        swap(rhs);
+    }
+
+    HeapNodes& operator=(HeapNodes&& rhs) noexcept {
+        swap(rhs);
+        return *this;
+    }
+
+    template<typename... Args>
+    T* create(Args&&... args) {
+        T* res = new T(std::forward<Args>(args)...);
+        size_++;
+        return res;
+    }
+
+    void destroy(T* ptr) {
+        delete ptr;
+        size_--;
+    }
+
+    //Nodes are owned by the tree, it destroys them before clear().
+    void clear() {
+        size_ = 0U;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    size_t capacity() const {
+        return size_;
+    }
+
+    void swap(HeapNodes& rhs) noexcept {
+        std::swap(size_, rhs.size_);
+    }
+};
+
+} //namespace tree
@@ -0,0 +1,58 @@
+#pragma once
+
+/*
+parallelSort(first, last, comp, threads). Sorts a random access range on several
+threads: the range is cut into one run per thread, the runs are sorted by std::sort
+concurrently and then merged pairwise by std::inplace_merge, the merges of one round
+also run concurrently. Ranges shorter than parallelSortMinRun per thread and single
+core machines go straight to std::sort. comp must not throw.
+*/
+
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
+
+namespace tree {
+
+inline constexpr size_t parallelSortMinRun = 1U << 16U;
+
+template<std::random_access_iterator It, class Compare>
+void parallelSort(It first, It last, Compare comp, size_t threads = std::thread::hardware_concurrency()) {
+    size_t n = static_cast<size_t>(last - first);
+    threads = std::min(threads, n / parallelSortMinRun);
+    if (threads < 2U) {
+        std::sort(first, last, comp);
+        return;
+    }
+    std::vector<It> bounds(threads + 1U);
+    for (size_t i = 0; i <= threads; ++i) {
+        bounds[i] = first + static_cast<std::ptrdiff_t>(n * i / threads);
+    }
+    auto inParallel = [] (size_t count, auto task) {
+        std::vector<std::thread> workers;
+        for (size_t i = 1U; i < count; ++i) {
+            workers.emplace_back(task, i);
+        }
+        task(0U);
+        for (auto& worker: workers) {
+            worker.join();
+        }
+    };
+    inParallel(threads, [&] (size_t i) {
+        std::sort(bounds[i], bounds[i + 1U], comp);
+    });
+    for (size_t width = 1U; width < threads; width *= 2U) {
+        inParallel((threads + 2U * width - 1U) / (2U * width), [&] (size_t pair) {
+            size_t lo = 2U * pair * width;
+            size_t mid = std::min(lo + width, threads);
+            size_t hi = std::min(lo + 2U * width, threads);
+            if (mid < hi) {
+                std::inplace_merge(bounds[lo], bounds[mid], bounds[hi], comp);
+            }
+        });
+    }
+}
+
+} //namespace tree
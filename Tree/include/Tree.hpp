@@ -5,7 +5,9 @@ Class Node. Tree consists from nodes.
 
 Class Iterator. To give possibility to iterate over the tree.
 
-Class Tree. Functionality:
+Class Tree. Nodes come from the Alloc policy (NodeArena by default, see NodeArena.hpp).
+Copies clone the node structure, moves take the nodes over. Functionality:
+    RBTree(first, last) - the tree of the keys in the range, see build
     begin() - iterator to smallest node in the tree
     end()   - iterator to nil
     rbegin() - reversed iterator to begin
@@ -13,18 +15,30 @@ Class Tree. Functionality:
     empty() - check whether tree is filles with something
     size() - returns number of the nodes in the tree
     root() - returns constant pointer to the root of the tree
-    clear() - delete every node from the tree
+    clear() - delete every node from the tree, O(1) per arena chunk for trivial keys
+    memory() - bytes of node storage held by the allocator
+    build(first, last) - replaces the keys by the ones in the range in O(n): the tree is
+                         built perfectly balanced, nodes on the deepest level are red, the
+                         rest black. Unsorted input is sorted by parallelSort first,
+                         duplicates are dropped
     insert(const key_type& key) - insert value in the tree
     erase(const key_type& key) - erase value from the tree
     find(const key_type& key) - returns iterator to the found node or to the nil(end)
     lower_bound(const key_type& key) - returns iterator to the lowest or equal node
     upper_bound(const key_type& key) - returns iterator to the greatest or equal node
     distance(iterator first, iterator last) - returns number of nodes in the range
+    select(size_t k) - iterator to the k-th smallest key (from 0), end() if k >= size()
+    rank(const key_type& key) - number of keys less than key
+    count_range(const key_type& lo, const key_type& hi) - number of keys in [lo, hi]
+    select, rank and count_range take one top-down descent using subtree sizes
     dump(std::fstream& file) - graphviz dump to the particular file
 */
 
+#include <bit>
+#include <array>
 #include <tuple>
 #include <memory>
+#include <vector>
 #include <cassert>
 #include <fstream>
 #include <cstddef>
@@ -32,7 +46,9 @@ Class Tree. Functionality:
 #include <iostream>
 #include <algorithm>
 #include <stdexcept>
-#include <unordered_set>
+#include <type_traits>
+#include "NodeArena.hpp"
+#include "ParallelSort.hpp"
 
 namespace tree {
 
@@ -40,7 +56,7 @@ template<typename K>
 struct Node;
 template<typename K>
 struct Iterator;
-template<typename K, class Compare = std::less<K>>
+template<typename K, class Compare = std::less<K>, class Alloc = NodeArena<Node<K>>>
 class RBTree;
 
 enum class Color: bool
@@ -214,7 +230,7 @@ struct Iterator final
     NodePtr node_ = nullptr;
 };
 
-template<typename K, class Compare>
+template<typename K, class Compare, class Alloc>
 class RBTree final
 {
 public:
@@ -229,25 +245,11 @@ public:
     using reverse_iterator = std::reverse_iterator<Iterator<K>>;
 
 private:
-    struct keyHash
-    {
-        std::size_t operator()(const Node<K>& node) const {
-            return std::hash<K>()(node.key_);
-        }
-    };
-
-    struct keyEqual
-    {
-        bool operator() (const Node<K>& lhs, const Node<K>& rhs) const {
-            return lhs.key_ == rhs.key_;
-        }
-    };
-
     Node<K> nilNode_ = Node<K>{};
     NodePtr root_ = nullptr;
     NodePtr nil_ = std::addressof(nilNode_);
 
-    std::unordered_set<Node<K>, keyHash, keyEqual> nodes_;
+    Alloc nodes_;
     Compare compare_;
 
     void nilInit() {
@@ -259,12 +261,88 @@ private:
     }
 
     NodePtr createNode(const K& key) {
-        auto it = nodes_.emplace(key).first;
-        return const_cast<NodePtr>(std::addressof(*it));
+        return nodes_.create(key);
     }
 
     void deleteNode(NodePtr node) {
-        nodes_.erase(*node);
+        nodes_.destroy(node);
+    }
+
+    void deleteNodes() {
+        if constexpr (!(Alloc::bulkRelease && std::is_trivially_destructible_v<Node<K>>)) {
+            NodePtr node = nil_->right_;
+            while (node != nil_) {
+                NodePtr next = node->next();
+                deleteNode(node);
+                node = next;
+            }
+        }
+        nodes_.clear();
+    }
+
+    //Clones the subtree of src with colors, tags and sizes; threads are set by linkThreads.
+    NodePtr cloneImpl(ConstNodePtr src, NodePtr parent, std::vector<NodePtr>& inorder) {
+        NodePtr node = createNode(src->key_);
+        node->parent_ = parent;
+        node->color_ = src->color_;
+        node->lTag_ = src->lTag_;
+        node->rTag_ = src->rTag_;
+        node->size_ = src->size_;
+        if (src->left()) {
+            node->left_ = cloneImpl(src->left_, node, inorder);
+        }
+        inorder.push_back(node);
+        if (src->right()) {
+            node->right_ = cloneImpl(src->right_, node, inorder);
+        }
+        return node;
+    }
+
+    void linkThreads(const std::vector<NodePtr>& inorder) {
+        for (size_t i = 0; i < inorder.size(); ++i) {
+            NodePtr node = inorder[i];
+            if (node->lTag_ == Tag::Thread) {
+                node->left_ = i ? inorder[i - 1U] : nil_;
+            }
+            if (node->rTag_ == Tag::Thread) {
+                node->right_ = i + 1U < inorder.size() ? inorder[i + 1U] : nil_;
+            }
+        }
+        nil_->right_ = inorder.empty() ? nil_ : inorder.front();
+        nil_->left_ = inorder.empty() ? nil_ : inorder.back();
+    }
+
+    void cloneFrom(const RBTree& rhs) {
+        if (!rhs.root_) {
+            return;
+        }
+        std::vector<NodePtr> inorder;
+        inorder.reserve(rhs.size());
+        root_ = cloneImpl(rhs.root_, nil_, inorder);
+        linkThreads(inorder);
+    }
+
+    //After nodes were taken from another tree, the links to its nil are redirected to ours.
+    void relinkNil(NodePtr oldNil) {
+        if (!root_) {
+            nilInit();
+            return;
+        }
+        root_->parent_ = nil_;
+        nil_->left_ = oldNil->left_;
+        nil_->right_ = oldNil->right_;
+        nil_->right_->left_ = nil_;
+        nil_->left_->right_ = nil_;
+    }
+
+    void swapImpl(RBTree& rhs) noexcept {
+        Node<K> nil = nilNode_;
+        Node<K> rhsNil = rhs.nilNode_;
+        std::swap(root_, rhs.root_);
+        nodes_.swap(rhs.nodes_);
+        std::swap(compare_, rhs.compare_);
+        relinkNil(std::addressof(rhsNil));
+        rhs.relinkNil(std::addressof(nil));
     }
 
     void rotateLeft(NodePtr x) {
@@ -344,6 +422,50 @@ private:
         return std::make_pair(false, prev);
     }
 
+    //Red-black height is at most 2 log2(n + 1), so any path fits.
+    static constexpr size_t maxDepth = 2U * 8U * sizeof(size_t);
+
+    struct Path
+    {
+        std::array<NodePtr, maxDepth> nodes;
+        size_t depth = 0U;
+
+        void push(NodePtr node) {
+            assert(depth < maxDepth);
+            nodes[depth++] = node;
+        }
+
+        void grow() {
+            for (size_t i = 0; i < depth; ++i) {
+                nodes[i]->size_++;
+            }
+        }
+
+        void shrink() {
+            for (size_t i = 0; i < depth; ++i) {
+                nodes[i]->size_--;
+            }
+        }
+    };
+
+    //One descent from the root: every node on the way is pushed to path.
+    std::pair<bool, NodePtr> descend(const K& key, Path& path) {
+        NodePtr prev = nil_;
+        NodePtr curr = root_;
+        while (curr) {
+            path.push(curr);
+            prev = curr;
+            if (compare_(curr->key_, key)) {
+                curr = curr->right();
+            } else if (compare_(key, curr->key_)) {
+                curr = curr->left();
+            } else {
+                return std::make_pair(true, curr);
+            }
+        }
+        return std::make_pair(false, prev);
+    }
+
     NodePtr findImpl(const K& key) {
         auto [found, node] = visit(key, [] (NodePtr&) {});
         return found ? node : nil_;
@@ -360,17 +482,21 @@ private:
         return node;
     }
 
+    //A new leaf threaded to nil is the new minimum (left thread) or maximum (right thread).
     void fixMinMaxInsert(NodePtr node) {
-        if (compare_(nil_->left_->key_, node->key_)) {
+        if (node->right_ == nil_) {
             nil_->left_ = node;
         }
-        if (compare_(node->key_, nil_->right_->key_)) {
+        if (node->left_ == nil_) {
             nil_->right_ = node;
         }
     }
 
+    //The path of the only descent gets its sizes incremented once the key is known to be new,
+    //so a duplicate leaves the tree untouched. Rotations of the fixup keep sizes themselves.
     NodePtr insertImpl(const K& key) {
-        auto [found, y] = visit(key, [] (NodePtr&) {});
+        Path path;
+        auto [found, y] = descend(key, path);
         if (found) {
             return y;
         }
@@ -381,20 +507,17 @@ private:
             return insertFirstNode(node);
         }
 
-        visit(key, [] (NodePtr& node_) { node_->size_++; });
+        path.grow();
         if (compare_(node->key_, y->key_)) {
             y->lTag_ = Tag::Child;
             node->left_ = y->left_;
             node->right_ = y;
             y->left_ = node;
-        } else if (compare_(y->key_, node->key_)) {
+        } else {
             y->rTag_ = Tag::Child;
             node->right_ = y->right_;
             node->left_ = y;
             y->right_ = node;
-        } else {
-            assert(0);
-            throw ("Node was found in tree");
         }
         fixMinMaxInsert(node);
         fixInsert(node);
@@ -483,7 +606,11 @@ private:
             *place = new_;
             new_->parent_ = old_->parent_;
             if (changeThreads) {
-                new_->rightMost()->right_ = old_->right_;
+                if (old_->left() == new_) {
+                    new_->rightMost()->right_ = old_->right_;
+                } else {
+                    new_->leftMost()->left_ = old_->left_;
+                }
             }
         } else if (old_ == root_) {
             root_ = nullptr;
@@ -532,8 +659,11 @@ private:
         }
     }
 
+    //The descent to the key continues to its successor when the node has two children,
+    //the whole path (up to the node actually unlinked) loses one in size.
     NodePtr eraseImpl(const K& key) {
-        auto [found, node] = visit(key, [] (NodePtr&) {});
+        Path path;
+        auto [found, node] = descend(key, path);
         if (!found) {
             return nil_;
         }
@@ -548,11 +678,16 @@ private:
         } else if (node->rTag_ == Tag::Thread) {
             x = node->lTag_ == Tag::Child ? node->left_ : nil_;
         } else {
-            y = node->right_->leftMost();
+            y = node->right_;
+            path.push(y);
+            while (y->left()) {
+                y = y->left_;
+                path.push(y);
+            }
             x = y->rTag_ == Tag::Child ? y->right_ : nil_;
             yColor = y->color_;
         }
-        visit(y->key_, [] (NodePtr& node_) { node_->size_--; });
+        path.shrink();
         NodePtr xParent = preFixErase(node, x, y);
         deleteNode(node);
         if (root_ && yColor == Color::Black) {
@@ -678,6 +813,55 @@ private:
         file.flush();
     }
 
+    //Builds the subtree of keys[lo, hi) in key order, so the nodes are allocated in key
+    //order too. prev is the node built last, its thread to the next node is set here.
+    template<typename RandomIt>
+    NodePtr buildImpl(RandomIt keys, size_t lo, size_t hi, size_t depth, size_t redDepth, NodePtr& prev) {
+        if (lo == hi) {
+            return nullptr;
+        }
+        size_t mid = lo + (hi - lo) / 2U;
+        NodePtr left = buildImpl(keys, lo, mid, depth + 1U, redDepth, prev);
+        NodePtr node = createNode(keys[mid]);
+        node->size_ = hi - lo;
+        node->color_ = depth == redDepth && depth ? Color::Red : Color::Black;
+        if (left) {
+            node->left_ = left;
+            node->lTag_ = Tag::Child;
+            left->parent_ = node;
+        } else {
+            node->left_ = prev;
+        }
+        if (prev == nil_) {
+            nil_->right_ = node;
+        } else if (prev->rTag_ == Tag::Thread) {
+            prev->right_ = node;
+        }
+        prev = node;
+        NodePtr right = buildImpl(keys, mid + 1U, hi, depth + 1U, redDepth, prev);
+        if (right) {
+            node->right_ = right;
+            node->rTag_ = Tag::Child;
+            right->parent_ = node;
+        }
+        return node;
+    }
+
+    //Keys must be strictly increasing. The subtrees of one level differ in size by one
+    //at most, so nil links hang from the two deepest levels only and coloring the
+    //deepest one red keeps the black height equal.
+    template<typename RandomIt>
+    void buildSorted(RandomIt keys, size_t n) {
+        if (!n) {
+            return;
+        }
+        NodePtr prev = nil_;
+        root_ = buildImpl(keys, 0U, n, 0U, std::bit_width(n) - 1U, prev);
+        root_->parent_ = nil_;
+        prev->right_ = nil_;
+        nil_->left_ = prev;
+    }
+
     size_t countNodesLess(NodePtr node) const {
         assert(node);
         if (node == nil_) {
@@ -702,6 +886,46 @@ public:
         nilInit();
     }
 
+    template<std::input_iterator It>
+    RBTree(It first, It last) {
+        nilInit();
+        build(first, last);
+    }
+
+    RBTree(const RBTree& rhs):
+        compare_(rhs.compare_) {
+        nilInit();
+        cloneFrom(rhs);
+    }
+
+    RBTree(RBTree&& rhs) noexcept {
+        nilInit();
+        swapImpl(rhs);
+    }
+
+    RBTree& operator=(const RBTree& rhs) {
+        if (this != std::addressof(rhs)) {
+            RBTree copy{rhs};
+            swapImpl(copy);
+        }
+        return *this;
+    }
+
+    RBTree& operator=(RBTree&& rhs) noexcept {
+        if (this != std::addressof(rhs)) {
+            swapImpl(rhs);
+        }
+        return *this;
+    }
+
+    ~RBTree() {
+        deleteNodes();
+    }
+
+    void swap(RBTree& rhs) noexcept {
+        swapImpl(rhs);
+    }
+
     iterator begin() const {
         return iterator(nil_->right_);
     }
@@ -731,11 +955,15 @@ public:
     }
 
     void clear() {
-        nodes_.clear();
+        deleteNodes();
         nilInit();
         root_ = nullptr;
     }
 
+    size_t memory() const {
+        return nodes_.capacity() * sizeof(Node<K>);
+    }
+
     bool operator==(const RBTree& rhs) const {
         return equal(rhs);
     }
@@ -744,6 +972,29 @@ public:
         return !equal(rhs);
     }
 
+    template<std::input_iterator It>
+    void build(It first, It last) {
+        auto notLess = [this] (const K& lhs, const K& rhs) {
+            return !compare_(lhs, rhs);
+        };
+        RBTree tree;
+        tree.compare_ = compare_;
+        if constexpr (std::random_access_iterator<It>) {
+            if (std::adjacent_find(first, last, notLess) == last) {
+                tree.buildSorted(first, static_cast<size_t>(last - first));
+                swapImpl(tree);
+                return;
+            }
+        }
+        std::vector<K> keys(first, last);
+        if (!std::is_sorted(keys.begin(), keys.end(), compare_)) {
+            parallelSort(keys.begin(), keys.end(), compare_);
+        }
+        keys.erase(std::unique(keys.begin(), keys.end(), notLess), keys.end());
+        tree.buildSorted(keys.begin(), keys.size());
+        swapImpl(tree);
+    }
+
     iterator insert(const K& key) {
         return iterator(insertImpl(key));
     }
@@ -808,6 +1059,75 @@ public:
         return countNodesLess(last.node_) - countNodesLess(first.node_);
     }
 
+    iterator select(size_t k) const {
+        NodePtr curr = root_;
+        while (curr) {
+            size_t left = curr->leftSize();
+            if (k < left) {
+                curr = curr->left_;
+            } else if (k > left) {
+                k -= left + 1U;
+                curr = curr->right();
+            } else {
+                return iterator(curr);
+            }
+        }
+        return end();
+    }
+
+    size_t rank(const K& key) const {
+        size_t res = 0U;
+        NodePtr curr = root_;
+        while (curr) {
+            if (compare_(curr->key_, key)) {
+                res += curr->leftSize() + 1U;
+                curr = curr->right();
+            } else {
+                curr = curr->left();
+            }
+        }
+        return res;
+    }
+
+    //Descends to the highest node inside [lo, hi], then its left subtree is walked for
+    //the keys >= lo and its right subtree for the keys <= hi.
+    size_t count_range(const K& lo, const K& hi) const {
+        if (compare_(hi, lo)) {
+            return 0U;
+        }
+        NodePtr split = root_;
+        while (split) {
+            if (compare_(split->key_, lo)) {
+                split = split->right();
+            } else if (compare_(hi, split->key_)) {
+                split = split->left();
+            } else {
+                break;
+            }
+        }
+        if (!split) {
+            return 0U;
+        }
+        size_t res = 1U;
+        for (NodePtr curr = split->left(); curr;) {
+            if (compare_(curr->key_, lo)) {
+                curr = curr->right();
+            } else {
+                res += curr->rightSize() + 1U;
+                curr = curr->left();
+            }
+        }
+        for (NodePtr curr = split->right(); curr;) {
+            if (compare_(hi, curr->key_)) {
+                curr = curr->left();
+            } else {
+                res += curr->leftSize() + 1U;
+                curr = curr->right();
+            }
+        }
+        return res;
+    }
+
     void dump(std::fstream& file) const {
         dumpImpl(file);
     }
@@ -9,12 +9,14 @@ This file contains function, that checks end_to_end tests.
 #include <set>
 #include <vector>
 #include "Tree.hpp"
+#include "BPTree.hpp"
 
 namespace tree
 {
 
-inline std::vector<int> myProcess(std::istream& in) {
-    RBTree<int> tree;
+template<class Tree>
+std::vector<int> treeProcess(std::istream& in) {
+    Tree tree;
     std::vector<int> output;
 
     int key = 0;
@@ -31,9 +33,7 @@ inline std::vector<int> myProcess(std::istream& in) {
                 output.push_back(0);
                 continue;
             }
-            auto lowIt = tree.lower_bound(lowerBound);
-            auto upIt = tree.upper_bound(upperBound);
-            output.push_back(tree.distance(lowIt, upIt));
+            output.push_back(tree.count_range(lowerBound, upperBound));
         } else if (cmd == 'e') {
             break;
         } else {
@@ -43,6 +43,14 @@ inline std::vector<int> myProcess(std::istream& in) {
     return output;
 }
 
+inline std::vector<int> myProcess(std::istream& in) {
+    return treeProcess<RBTree<int>>(in);
+}
+
+inline std::vector<int> bpProcess(std::istream& in) {
+    return treeProcess<BPTree<int>>(in);
+}
+
 inline std::vector<int> stdProcess(std::istream& in) {
     std::set<int> tree;
     std::vector<int> output;
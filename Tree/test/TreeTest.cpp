@@ -1,11 +1,13 @@
 #include <set>
 #include <chrono>
+#include <numeric>
 #include <fstream>
 #include <cstdlib>
 #include <filesystem>
 #include <gtest/gtest.h>
 #include "../include/Utils.hpp"
 #include "../include/Tree.hpp"
+#include "../include/BPTree.hpp"
 
 using namespace tree;
 
@@ -348,6 +350,269 @@ TEST(RBTreeTest, treeTest) {
     EXPECT_TRUE(checkProperty5(t));
 }
 
+TEST(RBTreeTest, treeTestCopyIsDeep) {
+    RBTree<int> t1;
+    for (int i = 1; i <= 100; ++i) {
+        t1.insert(i);
+    }
+    RBTree<int> t2{t1};
+    t2.erase(50);
+    t2.insert(1000);
+    EXPECT_EQ(t1.size(), 100U);
+    EXPECT_EQ(t2.size(), 100U);
+    EXPECT_TRUE(t1.find(50) != t1.end());
+    EXPECT_TRUE(t1.find(1000) == t1.end());
+    EXPECT_EQ(*t2.rbegin(), 1000);
+    EXPECT_EQ(t2.distance(t2.lower_bound(40), t2.upper_bound(60)), 20U);
+    EXPECT_TRUE(checkProperty3(t2));
+    EXPECT_TRUE(checkProperty4(t2));
+
+    RBTree<int> t3{std::move(t2)};
+    EXPECT_TRUE(t2.empty());
+    EXPECT_TRUE(t2.begin() == t2.end());
+    EXPECT_EQ(t3.size(), 100U);
+    EXPECT_EQ(std::distance(t3.begin(), t3.end()), 100);
+    EXPECT_EQ(std::distance(t3.rbegin(), t3.rend()), 100);
+    t3.insert(0);
+    EXPECT_EQ(*t3.begin(), 0);
+
+    t1.swap(t3);
+    EXPECT_EQ(t1.size(), 101U);
+    EXPECT_EQ(t3.size(), 100U);
+    EXPECT_EQ(*t3.rbegin(), 100);
+    t2 = t3;
+    EXPECT_TRUE(t2 == t3);
+}
+
+TEST(RBTreeTest, treeTestNodeAllocators) {
+    RBTree<int> arena;
+    RBTree<int, std::less<int>, HeapNodes<Node<int>>> heap;
+    std::set<int> set;
+    srand(46);
+    for (int i = 0; i < 20000; ++i) {
+        int key = std::rand() % 5000;
+        if (std::rand() % 3 == 0) {
+            arena.erase(key);
+            heap.erase(key);
+            set.erase(key);
+        } else {
+            arena.insert(key);
+            heap.insert(key);
+            set.insert(key);
+        }
+    }
+    EXPECT_TRUE(std::equal(arena.begin(), arena.end(), set.begin(), set.end()));
+    EXPECT_TRUE(std::equal(heap.begin(), heap.end(), set.begin(), set.end()));
+    EXPECT_TRUE(checkProperty4(arena));
+    //Freed nodes are reused, so the arena holds at most the peak number of keys.
+    EXPECT_LE(arena.memory(), 2U * 5000U * sizeof(Node<int>));
+    arena.clear();
+    EXPECT_EQ(arena.memory(), 0U);
+    arena.insert(7);
+    EXPECT_EQ(*arena.begin(), 7);
+    heap.clear();
+    EXPECT_TRUE(heap.empty());
+}
+
+TEST(RBTreeTest, treeTestOrderStatistics) {
+    RBTree<int> t;
+    std::set<int> set;
+    EXPECT_TRUE(t.select(0) == t.end());
+    EXPECT_EQ(t.rank(5), 0U);
+    EXPECT_EQ(t.count_range(0, 10), 0U);
+    srand(48);
+    for (int i = 0; i < 3000; ++i) {
+        int key = std::rand() % 2000;
+        if (std::rand() % 4 == 0) {
+            t.erase(key);
+            set.erase(key);
+        } else {
+            t.insert(key);
+            set.insert(key);
+        }
+    }
+    size_t k = 0U;
+    for (int key: set) {
+        EXPECT_EQ(*t.select(k), key);
+        EXPECT_EQ(t.rank(key), k);
+        k++;
+    }
+    EXPECT_TRUE(t.select(set.size()) == t.end());
+    EXPECT_EQ(t.rank(-1), 0U);
+    EXPECT_EQ(t.rank(5000), set.size());
+    for (int i = 0; i < 1000; ++i) {
+        int lo = std::rand() % 2200 - 100;
+        int hi = std::rand() % 2200 - 100;
+        size_t expected = lo <= hi ? std::distance(set.lower_bound(lo), set.upper_bound(hi)) : 0U;
+        EXPECT_EQ(t.count_range(lo, hi), expected);
+    }
+}
+
+//Keys are sorted within and across leaves, counts of inner nodes are sizes of the
+//children, every leaf is at the same depth.
+template<typename K>
+size_t checkBPNode(const BPHeader* node, size_t depth, size_t height) {
+    if (node->leaf_) {
+        auto leaf = static_cast<const BPLeaf<K>*>(node);
+        EXPECT_EQ(depth + 1U, height);
+        EXPECT_TRUE(std::is_sorted(leaf->keys_.begin(), leaf->keys_.begin() + leaf->count_));
+        return leaf->count_;
+    }
+    auto inner = static_cast<const BPInner<K>*>(node);
+    size_t res = 0U;
+    for (size_t i = 0; i < inner->count_; ++i) {
+        size_t count = checkBPNode<K>(inner->children_[i], depth + 1U, height);
+        EXPECT_EQ(count, inner->counts_[i]);
+        res += count;
+    }
+    return res;
+}
+
+bool checkBuilt(RBTree<int>& t, const std::set<int>& set) {
+    if (!std::equal(t.begin(), t.end(), set.begin(), set.end()) ||
+        !std::equal(t.rbegin(), t.rend(), set.rbegin(), set.rend()) || t.size() != set.size()) {
+        return false;
+    }
+    if (t.empty()) {
+        return true;
+    }
+    for (auto it = t.begin(); it != t.end(); ++it) {
+        if (it.node_->size_ != it.node_->size()) {
+            return false;
+        }
+    }
+    return checkProperty3(t) && checkProperty4(t) && checkProperty5(t);
+}
+
+TEST(RBTreeTest, treeTestBuild) {
+    for (int n = 0; n < 300; ++n) {
+        std::vector<int> keys(n);
+        std::iota(keys.begin(), keys.end(), 0);
+        RBTree<int> t{keys.begin(), keys.end()};
+        EXPECT_TRUE(checkBuilt(t, std::set<int>(keys.begin(), keys.end())));
+    }
+    srand(50);
+    std::vector<int> keys(5000);
+    for (int& key: keys) {
+        key = std::rand() % 3000;
+    }
+    std::set<int> set(keys.begin(), keys.end());
+    RBTree<int> t;
+    t.insert(-1);
+    t.build(keys.begin(), keys.end());
+    EXPECT_TRUE(checkBuilt(t, set));
+    for (int i = 0; i < 2000; ++i) {
+        int key = std::rand() % 4000;
+        if (i % 2) {
+            t.insert(key);
+            set.insert(key);
+        } else {
+            t.erase(key);
+            set.erase(key);
+        }
+    }
+    EXPECT_TRUE(checkBuilt(t, set));
+    t.build(set.begin(), set.end());
+    EXPECT_TRUE(checkBuilt(t, set));
+    t.build(keys.end(), keys.end());
+    EXPECT_TRUE(t.empty());
+    EXPECT_TRUE(t.begin() == t.end());
+}
+
+TEST(RBTreeTest, treeTestParallelSort) {
+    std::vector<int> keys(300000);
+    srand(51);
+    for (int& key: keys) {
+        key = std::rand();
+    }
+    std::vector<int> expected{keys};
+    std::sort(expected.begin(), expected.end());
+    for (size_t threads: {1U, 3U, 4U}) {
+        std::vector<int> sorted{keys};
+        parallelSort(sorted.begin(), sorted.end(), std::less<int>{}, threads);
+        EXPECT_TRUE(sorted == expected);
+    }
+}
+
+TEST(BPTreeTest, bpTreeTestMatchesSet) {
+    BPTree<int> t;
+    std::set<int> set;
+    EXPECT_TRUE(t.begin() == t.end());
+    EXPECT_TRUE(t.erase(1) == t.end());
+    srand(49);
+    for (int round = 0; round < 6; ++round) {
+        for (int i = 0; i < 20000; ++i) {
+            int key = std::rand() % 30000;
+            if (std::rand() % 3 < (round % 3 == 2 ? 2 : 1)) {
+                auto it = t.erase(key);
+                auto next = set.upper_bound(key);
+                bool erased = set.erase(key);
+                EXPECT_TRUE(!erased || next == set.end() ? it == t.end() : *it == *next);
+            } else {
+                EXPECT_EQ(*t.insert(key), key);
+                set.insert(key);
+            }
+        }
+        ASSERT_EQ(t.size(), set.size());
+        if (t.root()) {
+            EXPECT_EQ(checkBPNode<int>(t.root(), 0U, t.height()), set.size());
+        }
+        EXPECT_TRUE(std::equal(t.begin(), t.end(), set.begin(), set.end()));
+        EXPECT_TRUE(std::equal(t.rbegin(), t.rend(), set.rbegin(), set.rend()));
+    }
+    size_t k = 0U;
+    for (int key: set) {
+        EXPECT_EQ(*t.select(k), key);
+        EXPECT_EQ(t.rank(key), k);
+        k++;
+    }
+    EXPECT_TRUE(t.select(set.size()) == t.end());
+    for (int i = 0; i < 2000; ++i) {
+        int lo = std::rand() % 32000 - 1000;
+        int hi = std::rand() % 32000 - 1000;
+        auto it = t.lower_bound(lo);
+        EXPECT_TRUE(set.lower_bound(lo) == set.end() ? it == t.end() : *it == *set.lower_bound(lo));
+        it = t.upper_bound(lo);
+        EXPECT_TRUE(set.upper_bound(lo) == set.end() ? it == t.end() : *it == *set.upper_bound(lo));
+        EXPECT_EQ(t.find(lo) != t.end(), set.count(lo) == 1U);
+        size_t expected = lo <= hi ? std::distance(set.lower_bound(lo), set.upper_bound(hi)) : 0U;
+        EXPECT_EQ(t.count_range(lo, hi), expected);
+        EXPECT_EQ(t.distance(t.lower_bound(lo), t.upper_bound(hi)), expected);
+    }
+}
+
+TEST(BPTreeTest, bpTreeTestCopyMoveAndStrings) {
+    BPTree<std::string> t;
+    std::set<std::string> set;
+    for (int i = 0; i < 5000; ++i) {
+        std::string key = std::to_string(i * 7919 % 5000);
+        t.insert(key);
+        set.insert(key);
+    }
+    BPTree<std::string> copy{t};
+    for (int i = 0; i < 5000; i += 2) {
+        t.erase(std::to_string(i));
+    }
+    EXPECT_TRUE(std::equal(copy.begin(), copy.end(), set.begin(), set.end()));
+    EXPECT_EQ(t.size(), set.size() - 2500U);
+    EXPECT_EQ(checkBPNode<std::string>(t.root(), 0U, t.height()), t.size());
+
+    BPTree<std::string> moved{std::move(copy)};
+    EXPECT_TRUE(copy.empty());
+    EXPECT_TRUE(copy.begin() == copy.end());
+    EXPECT_EQ(moved.size(), set.size());
+    EXPECT_EQ(*--moved.end(), *set.rbegin());
+    moved.swap(t);
+    EXPECT_EQ(t.size(), set.size());
+    EXPECT_EQ(*t.begin(), *set.begin());
+    copy = t;
+    EXPECT_TRUE(copy == t);
+    t.clear();
+    EXPECT_TRUE(t.empty());
+    EXPECT_TRUE(t.rbegin() == t.rend());
+    EXPECT_TRUE(copy != t);
+}
+
 TEST(RBTreeTest, end2endTest) {
     namespace fs = std::filesystem;
     auto inputPath = fs::path{execPath}.parent_path() / "../tests";
@@ -366,9 +631,13 @@ TEST(RBTreeTest, end2endTest) {
         in.clear();
         in.seekg(0);
         auto out2 = stdProcess(in);
+        in.clear();
+        in.seekg(0);
+        auto out4 = bpProcess(in);
         auto out3 = result(out);
         EXPECT_TRUE(out1 == out3);
         EXPECT_TRUE(out2 == out3);
+        EXPECT_TRUE(out4 == out3);
     }
 }
 